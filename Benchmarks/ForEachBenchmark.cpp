@@ -0,0 +1,128 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+// Compares EntityHandler::ForEach to the equivalent loop over GetComponentTmpPointer for entities
+// in scattered order, like a bag after some churn. Built from the repository root, for example
+//     g++ -std=c++11 -O2 -DNDEBUG -I. ComponentFramework/*.cpp *.cpp Benchmarks/ForEachBenchmark.cpp -pthread
+// and run with the entity counts to measure, 100000 1000000 4000000 by default.
+
+struct Position
+{
+    float x, y, z;
+    float padding[13];
+    static const char* GetName() { return "Position"; }
+};
+
+struct Velocity
+{
+    float x, y, z;
+    float padding[13];
+    static const char* GetName() { return "Velocity"; }
+};
+
+struct Tag
+{
+    int value;
+    static const char* GetName() { return "Tag"; }
+};
+
+class MoveSystem : public Core::BaseSystem
+{
+public:
+    MoveSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+};
+
+typedef Core::SystemHandlerTemplate<MoveSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Velocity,Tag> EntityHandler;
+
+static const int REPEATS = 15;
+
+static void Move( Core::Entity, Position& position, Velocity& velocity )
+{
+    position.x += velocity.x * 0.01f;
+    position.y += velocity.y * 0.01f;
+    position.z += velocity.z * 0.01f;
+}
+
+static void Run( size_t count )
+{
+    SystemHandler systemHandler;
+    EntityHandler *entityHandler = new EntityHandler( &systemHandler );
+
+    std::mt19937 random( 1 );
+    std::vector<Core::Entity> ids;
+
+    //Add the components in a different order than the entities were created in,
+    //so both the entity rows and the component data are scattered
+    for( size_t i = 0; i < count; i++ )
+        ids.push_back( entityHandler->CreateEntity( Tag{ 0 } ) );
+
+    std::shuffle( ids.begin(), ids.end(), random );
+
+    Position position = Position();
+    position.x = 1.0f;
+    position.y = 2.0f;
+    position.z = 3.0f;
+
+    Velocity velocity = Velocity();
+    velocity.x = velocity.y = velocity.z = 1.0f;
+
+    for( size_t i = 0; i < count; i++ )
+        entityHandler->AddComponents( ids[i], position, velocity );
+
+    std::shuffle( ids.begin(), ids.end(), random );
+
+    double loopMs = 1e9;
+    double forEachMs = 1e9;
+
+    for( int r = 0; r < REPEATS; r++ )
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        for( size_t i = 0; i < ids.size(); i++ )
+        {
+            Position *position = entityHandler->GetComponentTmpPointer<Position>( ids[i] );
+            Velocity *velocity = entityHandler->GetComponentTmpPointer<Velocity>( ids[i] );
+
+            if( position != nullptr && velocity != nullptr )
+                Move( ids[i], *position, *velocity );
+        }
+
+        std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+
+        entityHandler->ForEach<Position,Velocity>( ids, Move );
+
+        std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+        loopMs = std::min( loopMs, std::chrono::duration<double,std::milli>( middle - start ).count() );
+        forEachMs = std::min( forEachMs, std::chrono::duration<double,std::milli>( end - middle ).count() );
+    }
+
+    std::printf( "%8zu entities: GetComponentTmpPointer %8.2f ms, ForEach %8.2f ms, %.2fx\n",
+        count, loopMs, forEachMs, loopMs / forEachMs );
+
+    delete entityHandler;
+}
+
+int main( int argc, char **argv )
+{
+    if( argc < 2 )
+    {
+        Run( 100000 );
+        Run( 1000000 );
+        Run( 4000000 );
+    }
+
+    for( int i = 1; i < argc; i++ )
+        Run( (size_t)std::strtoull( argv[i], nullptr, 10 ) );
+
+    return 0;
+}
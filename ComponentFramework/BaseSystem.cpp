@@ -8,6 +8,7 @@ Core::BaseSystem::BaseSystem( Aspect inclusive, Aspect exclusive )
 {
     m_inclusive = inclusive;
     m_exclusive = exclusive;
+    m_updatePolicy = UpdatePolicy::EveryFrame();
 }
 
 Core::BaseSystem::BaseSystem( std::vector<EntityBag> bags )
@@ -15,38 +16,52 @@ Core::BaseSystem::BaseSystem( std::vector<EntityBag> bags )
     m_bags = bags;
     m_inclusive = 0;
     m_exclusive = std::numeric_limits<Core::Aspect>::max();
+    m_updatePolicy = UpdatePolicy::EveryFrame();
+}
+
+Core::BaseSystem::BaseSystem()
+{
+    //Matches no aspect, so the system is never told about changes it has no list for
+    m_inclusive = std::numeric_limits<Core::Aspect>::max();
+    m_exclusive = std::numeric_limits<Core::Aspect>::max();
+    m_updatePolicy = UpdatePolicy::EveryFrame();
 }
 
 void Core::BaseSystem::ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp )
 {
-    //Remove if old matches
-    if( AspectMatch( old_asp ) )
+    bool matchesNew = AspectMatch( new_asp ) && new_asp != 0ULL;
+
+    //The list is protected, a system may have reordered it
+    if( id < m_entityIndex.size() && m_entityIndex[id] >= 0 && 
+        ( (size_t)m_entityIndex[id] >= m_entities.size() || m_entities[m_entityIndex[id]] != id ) )
+        RebuildEntityIndex();
+
+    bool contained = id < m_entityIndex.size() && m_entityIndex[id] >= 0;
+
+    //Remove if old matches, entities still matching keep their place
+    if( AspectMatch( old_asp ) && matchesNew == false )
     {
-        bool found = false;
-		std::vector<Entity>::iterator it;
-		for (it = m_entities.begin();
-             it != m_entities.end() && found == false;
-              )
+        if( contained )
         {
-            if( *it == id )
-            {
-                found = true;  
-            }
-			else
-			{
-				it++;
-			}
-        }
+            //Swap remove
+            size_t index = m_entityIndex[id];
 
-		if ( found )
-			m_entities.erase(it);
+            m_entities[index] = m_entities.back();
+            m_entityIndex[m_entities[index]] = (int)index;
+            m_entities.pop_back();
+            m_entityIndex[id] = -1;
+        }
 
-        assert( m_inclusive == 0 || found );
+        assert( m_inclusive == 0 || contained );
     }
 
     //Add if new matches
-    if( AspectMatch( new_asp ) && new_asp != 0ULL )
+    if( matchesNew && contained == false )
     {
+        if( id >= m_entityIndex.size() )
+            m_entityIndex.resize( id + 1, -1 );
+
+        m_entityIndex[id] = (int)m_entities.size();
         m_entities.push_back( id );
     }
 
@@ -58,7 +73,81 @@ void Core::BaseSystem::ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp
     }
 }
 
-bool Core::BaseSystem::AspectMatch( Aspect asp )
+void Core::BaseSystem::ChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp )
+{
+    if( old_asp != 0ULL )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            BaseSystem::ChangedEntity( ids[i], old_asp, new_asp );
+        }
+        return;
+    }
+
+    if( AspectMatch( new_asp ) && new_asp != 0ULL )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            if( ids[i] >= m_entityIndex.size() )
+                m_entityIndex.resize( ids[i] + 1, -1 );
+
+            m_entityIndex[ids[i]] = (int)( m_entities.size() + i );
+        }
+
+        m_entities.insert( m_entities.end(), ids, ids + count );
+    }
+
+    for( std::vector<EntityBag>::iterator it = m_bags.begin();
+            it != m_bags.end();
+            it++ )
+    {
+        it->ChangedEntities( ids, count, old_asp, new_asp );
+    }
+}
+
+void Core::BaseSystem::RebuildEntityIndex()
+{
+    m_entityIndex.assign( m_entityIndex.size(), -1 );
+
+    for( size_t i = 0; i < m_entities.size(); i++ )
+    {
+        if( m_entities[i] >= m_entityIndex.size() )
+            m_entityIndex.resize( m_entities[i] + 1, -1 );
+
+        m_entityIndex[m_entities[i]] = (int)i;
+    }
+}
+
+void Core::BaseSystem::ClearBagChanges()
+{
+    for( std::vector<EntityBag>::iterator it = m_bags.begin();
+            it != m_bags.end();
+            it++ )
+    {
+        it->ClearChanges();
+    }
+}
+
+int Core::BaseSystem::UseSharedBag( Aspect inclusive, Aspect exclusive )
+{
+    assert( m_sharedBags.size() == 0 );
+    m_sharedRequests.push_back( std::pair<Aspect,Aspect>( inclusive, exclusive ) );
+    return (int)m_sharedRequests.size() - 1;
+}
+
+void Core::BaseSystem::BindSharedBags( EntityBagRegistry& registry )
+{
+    m_sharedBags.resize( m_sharedRequests.size() );
+
+    for( size_t i = 0; i < m_sharedRequests.size(); i++ )
+    {
+        m_sharedBags[i] = registry.Intern( m_sharedRequests[i].first, m_sharedRequests[i].second );
+    }
+}
+
+void Core::BaseSystem::SetUpdatePolicy( const UpdatePolicy& policy )
 {
-    return ((m_inclusive & asp) == m_inclusive) && ((m_exclusive & asp) == 0 );
+    assert( policy.type != UpdatePolicy::FIXED_STEP || policy.step > 0.0f );
+    assert( policy.interval > 0 && policy.maxSteps > 0 );
+    m_updatePolicy = policy;
 }
@@ -2,8 +2,13 @@
 #define SRC_CORE_COMPONENTFRAMEWORK_BASESYSTEM_H
 #include "SystemTypes.hpp"
 #include "EntityBag.hpp"
+#include "EntityBagRegistry.hpp"
+#include "UpdatePolicy.hpp"
 
 #include <vector>
+#include <utility>
+#include <chrono>
+#include <cassert>
 
 namespace Core
 {
@@ -25,6 +30,12 @@ namespace Core
         */
         BaseSystem( std::vector<EntityBag> bags );
 
+        /*!
+            Constructor for systems that only use shared bags, see UseSharedBag.
+            The system doesn't keep any entity list of its own.
+        */
+        BaseSystem();
+
         virtual ~BaseSystem() {}
         
         /*!
@@ -32,6 +43,13 @@ namespace Core
         */
         virtual void Update( float delta ) = 0;
 
+        /*!
+            Update call for systems given a frame budget by the SystemHandler.
+            Systems that can split their work over several frames override this,
+            the default ignores the budget and calls Update.
+        */
+        virtual void UpdateSliced( float delta, std::chrono::microseconds /*budget*/ ) { Update( delta ); }
+
         /*!
             Changed entity, called every time entities are created, removed or if their
             Aspect has changed
@@ -39,23 +57,90 @@ namespace Core
 
         virtual void ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp );
 
-        bool AspectMatch( Aspect asp );
+        /*!
+            Batched version of ChangedEntity for many entities going through the same change,
+            like a prefab instantiation. New entities are appended to the lists in one go.
+            Only used by the SystemHandler for systems that don't override ChangedEntity.
+        */
+        void ChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp );
+
+        bool AspectMatch( Aspect asp )
+        {
+            return ((m_inclusive & asp) == m_inclusive) && ((m_exclusive & asp) == 0 );
+        }
+
+        /*!
+            Clears the added and removed lists of all bags, called by the SystemHandler
+            after each Update so every change is seen exactly once.
+        */
+        void ClearBagChanges();
+
+        /*!
+            Returns false if the change can't affect the entity list or bags of the system,
+            used by the SystemHandler to skip the ChangedEntity call.
+        */
+        bool IsAffected( Aspect old_asp, Aspect new_asp )
+        {
+            return m_bags.size() > 0 || AspectMatch( old_asp ) || AspectMatch( new_asp );
+        }
 
         virtual const char * GetHumanName() { return "System"; }
+
+        /*!
+            Sets how often the SystemHandler updates this system.
+            Should be set from the systems constructor, or through the SystemHandler
+            if changed afterwards so that staggered phases are recalculated.
+        */
+        void SetUpdatePolicy( const UpdatePolicy& policy );
+
+        const UpdatePolicy& GetUpdatePolicy() { return m_updatePolicy; }
+
+        /*!
+            Resolves the shared bags requested with UseSharedBag,
+            called once by the SystemHandler when it is created.
+        */
+        void BindSharedBags( EntityBagRegistry& registry );
+
     protected:
+        /*!
+            Requests a bag shared with every other system using the same aspects,
+            call from the systems constructor. Returns the index to pass to GetSharedBag.
+        */
+        int UseSharedBag( Aspect inclusive, Aspect exclusive );
+
+        /*!
+            Returns a shared bag, available once the SystemHandler is created.
+            The bag is updated by the SystemHandler before any system is told about the change.
+        */
+        const EntityBag& GetSharedBag( int index )
+        {
+            assert( index >= 0 && index < (int)m_sharedBags.size() && m_sharedBags[index] != nullptr );
+            return *m_sharedBags[index];
+        }
+
         /*!
             Systems personal entities list.
-            Kept for backwards compatability
+            Kept for backwards compatability. Entities leaving are swap removed, 
+            so the order is not kept.
         */
         std::vector<Entity> m_entities;
 
         /*!
-            Bags containing entities
+            Bags containing entities. Bags tracking changes collect the entities 
+            that joined and left them since the last Update, for the system to handle 
+            in bulk at the start of its Update.
         */
         std::vector<EntityBag> m_bags;
 
     private:
+        void RebuildEntityIndex();
+
         Aspect m_inclusive, m_exclusive;
+        UpdatePolicy m_updatePolicy;
+        std::vector<int> m_entityIndex;
+
+        std::vector<std::pair<Aspect,Aspect>> m_sharedRequests;
+        std::vector<EntityBag*> m_sharedBags;
 
     };
 }
@@ -0,0 +1,155 @@
+#include "ColdStore.hpp"
+
+#include <cstring>
+#include <cassert>
+
+namespace Core
+{
+    ColdStore::ColdStore()
+    {
+        m_count = 0;
+        m_garbage = 0;
+    }
+
+    void ColdStore::Store( Entity id, const unsigned char *data, const unsigned char *reference, size_t size )
+    {
+        Erase( id );
+
+        if( id >= m_records.size() )
+        {
+            Record empty = { NO_BLOB, 0 };
+            m_records.resize( id + 1, empty );
+        }
+
+        size_t offset = m_arena.size();
+
+        //Pairs of a zero run and the literal bytes following it, over data xor reference
+        size_t i = 0;
+        while( i < size )
+        {
+            size_t zeros = 0;
+            while( i + zeros < size && data[i+zeros] == reference[i+zeros] )
+                zeros++;
+
+            size_t literals = 0;
+            while( i + zeros + literals < size && data[i+zeros+literals] != reference[i+zeros+literals] )
+                literals++;
+
+            WriteVarint( m_arena, zeros );
+            WriteVarint( m_arena, literals );
+
+            for( size_t l = i + zeros; l < i + zeros + literals; l++ )
+                m_arena.push_back( data[l] ^ reference[l] );
+
+            i += zeros + literals;
+        }
+
+        assert( m_arena.size() < NO_BLOB );
+
+        m_records[id].offset = (uint32_t)offset;
+        m_records[id].size = (uint32_t)( m_arena.size() - offset );
+        m_count++;
+    }
+
+    bool ColdStore::Load( Entity id, const unsigned char *reference, unsigned char *out, size_t size )
+    {
+        if( Contains( id ) == false )
+            return false;
+
+        if( size == 0 )
+            return true;
+
+        const unsigned char *in = &m_arena[0] + m_records[id].offset;
+
+        size_t i = 0;
+        while( i < size )
+        {
+            size_t zeros = ReadVarint( in );
+            size_t literals = ReadVarint( in );
+
+            assert( i + zeros + literals <= size );
+
+            memcpy( out + i, reference + i, zeros );
+            i += zeros;
+
+            for( size_t l = 0; l < literals; l++, i++ )
+                out[i] = *in++ ^ reference[i];
+        }
+
+        return true;
+    }
+
+    void ColdStore::Erase( Entity id )
+    {
+        if( Contains( id ) == false )
+            return;
+
+        m_garbage += m_records[id].size;
+        m_records[id].offset = NO_BLOB;
+        m_records[id].size = 0;
+        m_count--;
+
+        if( m_garbage > 4096 && m_garbage * 2 > m_arena.size() )
+            Compact();
+    }
+
+    size_t ColdStore::GetCount()
+    {
+        return m_count;
+    }
+
+    size_t ColdStore::GetMemoryUse()
+    {
+        return m_arena.size();
+    }
+
+    void ColdStore::WriteVarint( std::vector<unsigned char>& out, size_t value )
+    {
+        while( value >= 0x80 )
+        {
+            out.push_back( (unsigned char)( value | 0x80 ) );
+            value >>= 7;
+        }
+
+        out.push_back( (unsigned char)value );
+    }
+
+    size_t ColdStore::ReadVarint( const unsigned char *& in )
+    {
+        size_t value = 0;
+        int shift = 0;
+
+        while( *in & 0x80 )
+        {
+            value |= (size_t)( *in++ & 0x7F ) << shift;
+            shift += 7;
+        }
+
+        value |= (size_t)( *in++ ) << shift;
+        return value;
+    }
+
+    void ColdStore::Compact()
+    {
+        std::vector<unsigned char> arena;
+        arena.reserve( m_arena.size() - m_garbage );
+
+        for( size_t id = 0; id < m_records.size(); id++ )
+        {
+            Record& record = m_records[id];
+
+            if( record.offset == NO_BLOB )
+                continue;
+
+            uint32_t offset = (uint32_t)arena.size();
+            arena.insert( arena.end(), m_arena.begin() + record.offset, m_arena.begin() + record.offset + record.size );
+            record.offset = offset;
+        }
+
+        m_arena.swap( arena );
+        m_garbage = 0;
+
+        while( m_records.size() > 0 && m_records.back().offset == NO_BLOB )
+            m_records.pop_back();
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_COLDSTORE_H
+#define SRC_CORE_COMPONENTFRAMEWORK_COLDSTORE_H
+
+#include "SystemTypes.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace Core
+{
+    /*!
+        ColdStore, internal datastructure used by the EntityHandler
+        to keep the components of frozen entities in compressed form.
+
+        Each entity is stored as the difference to a reference, normally the component defaults,
+        so unchanged bytes become zero and runs of zeros are stored as a single count.
+        Components that mostly keep their default values shrink to a few bytes, the encoding is 
+        lossless so a frozen entity comes back exactly as it was.
+
+        All blobs live in one arena indexed by entity id. Erased blobs leave holes 
+        that are reclaimed once they make up half the arena.
+    */
+    class ColdStore
+    {
+    public:
+        ColdStore();
+
+        /*!
+            Compresses size bytes of data against reference and stores them for the entity,
+            replacing anything stored for it before.
+        */
+        void Store( Entity id, const unsigned char *data, const unsigned char *reference, size_t size );
+
+        /*!
+            Decompresses the entities data against the same reference it was stored with.
+            Returns false if nothing is stored for the entity.
+        */
+        bool Load( Entity id, const unsigned char *reference, unsigned char *out, size_t size );
+
+        void Erase( Entity id );
+
+        bool Contains( Entity id )
+        {
+            return id < m_records.size() && m_records[id].offset != NO_BLOB;
+        }
+
+        /*!
+            Returns the number of stored entities.
+        */
+        size_t GetCount();
+
+        /*!
+            Returns the size in bytes of the arena, including holes.
+        */
+        size_t GetMemoryUse();
+
+    private:
+        static const uint32_t NO_BLOB = 0xFFFFFFFF;
+
+        struct Record
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        static void WriteVarint( std::vector<unsigned char>& out, size_t value );
+        static size_t ReadVarint( const unsigned char *& in );
+
+        void Compact();
+
+        std::vector<Record> m_records;
+        std::vector<unsigned char> m_arena;
+        size_t m_count;
+        size_t m_garbage;
+    };
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "ComponentRegistry.hpp"
+
+#include <cstring>
+#include <cassert>
+
+namespace Core
+{
+    void ComponentRegistry::Register( const ComponentTypeInfo& info )
+    {
+        assert( info.type == m_types.size() );
+        m_types.push_back( info );
+    }
+
+    size_t ComponentRegistry::GetCount() const
+    {
+        return m_types.size();
+    }
+
+    const ComponentTypeInfo& ComponentRegistry::Get( ComponentType type ) const
+    {
+        assert( type < m_types.size() );
+        return m_types[type];
+    }
+
+    int ComponentRegistry::Find( const char *name ) const
+    {
+        for( size_t i = 0; i < m_types.size(); i++ )
+        {
+            if( strcmp( m_types[i].name, name ) == 0 )
+                return (int)i;
+        }
+
+        return -1;
+    }
+
+    const ComponentField* ComponentRegistry::FindField( ComponentType type, const char *name ) const
+    {
+        const std::vector<ComponentField>& fields = Get( type ).fields;
+
+        for( size_t i = 0; i < fields.size(); i++ )
+        {
+            if( strcmp( fields[i].name, name ) == 0 )
+                return &fields[i];
+        }
+
+        return nullptr;
+    }
+
+    Aspect ComponentRegistry::GetAspect( const char * const *names, size_t count ) const
+    {
+        Aspect asp = 0ULL;
+
+        for( size_t i = 0; i < count; i++ )
+        {
+            int type = Find( names[i] );
+
+            if( type < 0 )
+                return 0ULL;
+
+            asp |= 1ULL << type;
+        }
+
+        return asp;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_COMPONENTREGISTRY_H
+#define SRC_CORE_COMPONENTFRAMEWORK_COMPONENTREGISTRY_H
+
+#include "SystemTypes.hpp"
+#include "ComponentTraits.hpp"
+
+#include <vector>
+
+namespace Core
+{
+    struct ComponentTypeInfo
+    {
+        const char *name;
+        ComponentType type;
+        size_t size;
+        bool doubleBuffered;
+        std::vector<ComponentField> fields;
+    };
+
+    /*!
+        Zero-copy view of the storage of one component type, see EntityHandler::GetComponentView.
+        Components are found at data + componentId * typesize, slots up to count may be unused.
+        previous is the read buffer of double buffered components and the same as data otherwise.
+    */
+    struct ComponentView
+    {
+        void *data;
+        const void *previous;
+        size_t typesize;
+        size_t count;
+    };
+
+    /*!
+        ComponentRegistry, runtime description of the component types of an EntityHandler,
+        their type ids, sizes and field layouts. Filled by the EntityHandler, 
+        primarily for scripting layers that look components and fields up by name.
+    */
+    class ComponentRegistry
+    {
+    public:
+        /*!
+            Adds a type, types are added in type id order.
+        */
+        void Register( const ComponentTypeInfo& info );
+
+        size_t GetCount() const;
+
+        const ComponentTypeInfo& Get( ComponentType type ) const;
+
+        /*!
+            Returns the type id of the named component, or -1 if there is none.
+        */
+        int Find( const char *name ) const;
+
+        /*!
+            Returns the named field of a component, or nullptr if it has none by that name.
+        */
+        const ComponentField* FindField( ComponentType type, const char *name ) const;
+
+        /*!
+            Returns the aspect of the named components, or 0 if any of them doesn't exist.
+        */
+        Aspect GetAspect( const char * const *names, size_t count ) const;
+
+    private:
+        std::vector<ComponentTypeInfo> m_types;
+    };
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_COMPONENTTRAITS_H
+#define SRC_CORE_COMPONENTFRAMEWORK_COMPONENTTRAITS_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+    Enables double buffered storage for a component type, 
+    must be used in the global namespace before the EntityHandler is instantiated.
+*/
+#define DOUBLE_BUFFERED_COMPONENT( Component ) \
+    namespace Core { template<> struct DoubleBuffered<Component> { static const bool value = true; }; }
+
+/*!
+    Describes the fields of a component for the ComponentRegistry, 
+    must be used in the global namespace like
+    COMPONENT_FIELDS( Position, COMPONENT_FIELD( Position, x ), COMPONENT_FIELD( Position, y ) )
+*/
+#define COMPONENT_FIELDS( Component, ... ) \
+    namespace Core { template<> struct ComponentFields<Component> { static std::vector<ComponentField> Get() { return { __VA_ARGS__ }; } }; }
+
+#define COMPONENT_FIELD( Component, field ) \
+    Core::ComponentField{ #field, offsetof( Component, field ), sizeof( Component::field ), Core::FieldTypeOf<decltype( Component::field )>::value }
+
+namespace Core
+{
+    /*!
+        Compile-time switches describing how the EntityHandler
+        stores a given component type. Specialize through the macros above.
+    */
+
+    /*!
+        Double buffered components keep last frames data readable through
+        GetComponentReadPointer while the current frame is written through GetComponentTmpPointer.
+        See PVector for details.
+    */
+    template<typename Component>
+    struct DoubleBuffered
+    {
+        static const bool value = false;
+    };
+
+    /*!
+        Basic type of a component field, the width follows from the fields size.
+        Array fields have the type of their elements.
+    */
+    enum FieldType
+    {
+        FIELD_UNKNOWN,
+        FIELD_FLOAT,
+        FIELD_INT,
+        FIELD_UINT,
+        FIELD_BOOL
+    };
+
+    struct ComponentField
+    {
+        const char *name;
+        size_t offset;
+        size_t size;
+        FieldType type;
+    };
+
+    template<typename T> struct FieldTypeOf { static const FieldType value = FIELD_UNKNOWN; };
+    template<typename T, size_t N> struct FieldTypeOf<T[N]> { static const FieldType value = FieldTypeOf<T>::value; };
+    template<> struct FieldTypeOf<float> { static const FieldType value = FIELD_FLOAT; };
+    template<> struct FieldTypeOf<double> { static const FieldType value = FIELD_FLOAT; };
+    template<> struct FieldTypeOf<char> { static const FieldType value = FIELD_INT; };
+    template<> struct FieldTypeOf<int8_t> { static const FieldType value = FIELD_INT; };
+    template<> struct FieldTypeOf<int16_t> { static const FieldType value = FIELD_INT; };
+    template<> struct FieldTypeOf<int32_t> { static const FieldType value = FIELD_INT; };
+    template<> struct FieldTypeOf<int64_t> { static const FieldType value = FIELD_INT; };
+    template<> struct FieldTypeOf<uint8_t> { static const FieldType value = FIELD_UINT; };
+    template<> struct FieldTypeOf<uint16_t> { static const FieldType value = FIELD_UINT; };
+    template<> struct FieldTypeOf<uint32_t> { static const FieldType value = FIELD_UINT; };
+    template<> struct FieldTypeOf<uint64_t> { static const FieldType value = FIELD_UINT; };
+    template<> struct FieldTypeOf<bool> { static const FieldType value = FIELD_BOOL; };
+
+    /*!
+        Field layout of a component, used by scripting layers to access component data
+        without knowing the type. Components without fields can still be copied whole.
+    */
+    template<typename Component>
+    struct ComponentFields
+    {
+        static std::vector<ComponentField> Get() { return std::vector<ComponentField>(); }
+    };
+}
+
+#endif
@@ -2,51 +2,347 @@
 
 #include "SystemTypes.hpp"
 #include <cassert>
+#include <algorithm>
+#include <utility>
 
 namespace Core
 {
-    EntityBag::EntityBag( Aspect inclusive, Aspect exclusive )
+    /*!
+        Stable least significant digit radix sort on the key, 8 bits per pass.
+        Passes where every key has the same digit are skipped.
+    */
+    static void RadixSort( std::vector<std::pair<uint32_t,Entity>>& items )
+    {
+        std::vector<std::pair<uint32_t,Entity>> tmp( items.size() );
+
+        for( int shift = 0; shift < 32; shift += 8 )
+        {
+            size_t counts[257] = { 0 };
+
+            for( size_t i = 0; i < items.size(); i++ )
+                counts[((items[i].first >> shift) & 0xFF) + 1]++;
+
+            bool skip = false;
+            for( int d = 1; d <= 256; d++ )
+            {
+                if( counts[d] == items.size() )
+                    skip = true;
+            }
+
+            if( skip )
+                continue;
+
+            for( int d = 1; d <= 256; d++ )
+                counts[d] += counts[d-1];
+
+            for( size_t i = 0; i < items.size(); i++ )
+                tmp[counts[(items[i].first >> shift) & 0xFF]++] = items[i];
+
+            items.swap( tmp );
+        }
+    }
+
+    EntityBag::EntityBag( Aspect inclusive, Aspect exclusive, bool trackChanges )
     {
         m_inclusive = inclusive;
         m_exclusive = exclusive;
+        m_cursor = 0;
+        m_trackChanges = trackChanges;
+        m_sortKey = nullptr;
+        m_sortContext = nullptr;
     }
 
     void EntityBag::ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp )
     {
-        //Remove if old matches
-        if( AspectMatch( old_asp ) )
+        bool matchesNew = AspectMatch( new_asp ) && new_asp != 0ULL;
+
+        //Remove if old matches, entities still matching keep their place
+        if( AspectMatch( old_asp ) && matchesNew == false )
         {
-            bool found = false;
-            std::vector<Entity>::iterator it;
-            for (it = m_entities.begin();
-                 it != m_entities.end() && found == false;
-                  )
+            bool found = Remove( id );
+
+            assert( m_inclusive == 0 || found );
+            (void)found;
+        }
+
+        //Add if new matches
+        if( matchesNew && Contains( id ) == false )
+        {
+            Insert( id );
+        }
+
+        if( m_trackChanges || m_sortKey != nullptr )
+        {
+            bool wasIn = AspectMatch( old_asp ) && old_asp != 0ULL;
+            bool isIn = AspectMatch( new_asp ) && new_asp != 0ULL;
+
+            if( isIn && wasIn == false )
             {
-                if( *it == id )
-                {
-                    found = true;  
-                }
-                else
+                if( m_trackChanges )
+                    PushListed( m_added, m_addedIndex, id );
+
+                if( m_sortKey != nullptr )
+                    SortJoined( id );
+            }
+            else if( wasIn && isIn == false )
+            {
+                if( m_trackChanges )
                 {
-                    it++;
+                    //Joining and leaving within the same period cancel out
+                    if( EraseListed( m_added, m_addedIndex, id ) == false )
+                        m_removed.push_back( id );
                 }
-            }
 
-            if ( found )
-                m_entities.erase(it);
+                if( m_sortKey != nullptr )
+                    SortLeft( id );
+            }
+        }
+    }
 
-            assert( m_inclusive == 0 || found );
+    void EntityBag::ChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp )
+    {
+        if( old_asp != 0ULL )
+        {
+            for( size_t i = 0; i < count; i++ )
+            {
+                ChangedEntity( ids[i], old_asp, new_asp );
+            }
+            return;
         }
 
-        //Add if new matches
         if( AspectMatch( new_asp ) && new_asp != 0ULL )
         {
-            m_entities.push_back( id );
+            for( size_t i = 0; i < count; i++ )
+                SetIndex( ids[i], (int)( m_entities.size() + i ) );
+
+            m_entities.insert( m_entities.end(), ids, ids + count );
+
+            if( m_trackChanges )
+            {
+                for( size_t i = 0; i < count; i++ )
+                    PushListed( m_added, m_addedIndex, ids[i] );
+            }
+
+            if( m_sortKey != nullptr )
+            {
+                for( size_t i = 0; i < count; i++ )
+                    SortJoined( ids[i] );
+            }
+        }
+    }
+
+    bool EntityBag::Contains( Entity id )
+    {
+        if( id >= m_index.size() || m_index[id] < 0 )
+            return false;
+
+        //m_entities is public, the owner may have reordered it
+        if( (size_t)m_index[id] >= m_entities.size() || m_entities[m_index[id]] != id )
+        {
+            m_index.assign( m_index.size(), -1 );
+
+            for( size_t i = 0; i < m_entities.size(); i++ )
+                SetIndex( m_entities[i], (int)i );
+        }
+
+        return m_index[id] >= 0;
+    }
+
+    void EntityBag::Insert( Entity id )
+    {
+        SetIndex( id, (int)m_entities.size() );
+        m_entities.push_back( id );
+    }
+
+    bool EntityBag::Remove( Entity id )
+    {
+        if( Contains( id ) == false )
+            return false;
+
+        size_t index = m_index[id];
+        size_t last = m_entities.size() - 1;
+
+        //Swap remove, keeping entities before the cursor before it
+        if( index < m_cursor )
+        {
+            size_t visited = m_cursor - 1;
+
+            m_entities[index] = m_entities[visited];
+            m_index[m_entities[index]] = (int)index;
+
+            index = visited;
+            m_cursor--;
+        }
+
+        m_entities[index] = m_entities[last];
+        m_index[m_entities[index]] = (int)index;
+
+        m_entities.pop_back();
+        m_index[id] = -1;
+
+        return true;
+    }
+
+    void EntityBag::SetIndex( Entity id, int index )
+    {
+        if( id >= m_index.size() )
+            m_index.resize( id + 1, -1 );
+
+        m_index[id] = index;
+    }
+
+    void EntityBag::ClearChanges()
+    {
+        for( size_t i = 0; i < m_added.size(); i++ )
+            m_addedIndex[m_added[i]] = -1;
+
+        m_added.clear();
+        m_removed.clear();
+    }
+
+    void EntityBag::SetSortKey( SortKeyFunction keyFunction, void *context )
+    {
+        m_sortKey = keyFunction;
+        m_sortContext = context;
+
+        m_sortedEntities.clear();
+        m_sortedKeys.clear();
+        m_groups.clear();
+        m_sortLeft.clear();
+
+        for( size_t i = 0; i < m_sortJoined.size(); i++ )
+            m_sortJoinedIndex[m_sortJoined[i]] = -1;
+
+        m_sortJoined.clear();
+        for( size_t i = 0; i < m_entities.size(); i++ )
+            PushListed( m_sortJoined, m_sortJoinedIndex, m_entities[i] );
+    }
+
+    void EntityBag::Sort()
+    {
+        if( m_sortKey == nullptr )
+            return;
+
+        std::sort( m_sortLeft.begin(), m_sortLeft.end() );
+
+        std::vector<std::pair<uint32_t,Entity>> changed;
+        changed.reserve( m_sortJoined.size() );
+
+        //Keep entities whose key is unchanged, compacting in place so the kept part stays sorted
+        size_t kept = 0;
+        for( size_t i = 0; i < m_sortedEntities.size(); i++ )
+        {
+            Entity id = m_sortedEntities[i];
+
+            if( std::binary_search( m_sortLeft.begin(), m_sortLeft.end(), id ) )
+                continue;
+
+            uint32_t key = m_sortKey( id, m_sortContext );
+
+            if( key == m_sortedKeys[i] )
+            {
+                m_sortedEntities[kept] = id;
+                m_sortedKeys[kept] = key;
+                kept++;
+            }
+            else
+            {
+                changed.push_back( std::pair<uint32_t,Entity>( key, id ) );
+            }
+        }
+
+        m_sortedEntities.resize( kept );
+        m_sortedKeys.resize( kept );
+
+        for( size_t i = 0; i < m_sortJoined.size(); i++ )
+        {
+            changed.push_back( std::pair<uint32_t,Entity>( m_sortKey( m_sortJoined[i], m_sortContext ), m_sortJoined[i] ) );
+        }
+
+        for( size_t i = 0; i < m_sortJoined.size(); i++ )
+            m_sortJoinedIndex[m_sortJoined[i]] = -1;
+
+        m_sortJoined.clear();
+        m_sortLeft.clear();
+
+        RadixSort( changed );
+
+        //Merge the changed entities into the kept ones
+        std::vector<Entity> entities( kept + changed.size() );
+        std::vector<uint32_t> keys( kept + changed.size() );
+
+        size_t a = 0, b = 0;
+        for( size_t i = 0; i < entities.size(); i++ )
+        {
+            if( b >= changed.size() || ( a < kept && m_sortedKeys[a] <= changed[b].first ) )
+            {
+                entities[i] = m_sortedEntities[a];
+                keys[i] = m_sortedKeys[a];
+                a++;
+            }
+            else
+            {
+                entities[i] = changed[b].second;
+                keys[i] = changed[b].first;
+                b++;
+            }
+        }
+
+        m_sortedEntities.swap( entities );
+        m_sortedKeys.swap( keys );
+
+        m_groups.clear();
+        for( size_t i = 0; i < m_sortedKeys.size(); i++ )
+        {
+            if( m_groups.size() == 0 || m_groups.back().key != m_sortedKeys[i] )
+            {
+                EntityGroup group = { m_sortedKeys[i], i, 0 };
+                m_groups.push_back( group );
+            }
+
+            m_groups.back().count++;
         }
     }
 
+    void EntityBag::SortJoined( Entity id )
+    {
+        PushListed( m_sortJoined, m_sortJoinedIndex, id );
+    }
+
+    void EntityBag::SortLeft( Entity id )
+    {
+        //Joining and leaving between two Sorts cancel out
+        if( EraseListed( m_sortJoined, m_sortJoinedIndex, id ) == false )
+            m_sortLeft.push_back( id );
+    }
+
     bool EntityBag::AspectMatch( Aspect asp )
     {
         return ((m_inclusive & asp) == m_inclusive) && ((m_exclusive & asp) == 0 );
     }
+
+    void EntityBag::PushListed( std::vector<Entity>& list, std::vector<int>& positions, Entity id )
+    {
+        if( id >= positions.size() )
+            positions.resize( id + 1, -1 );
+
+        positions[id] = (int)list.size();
+        list.push_back( id );
+    }
+
+    bool EntityBag::EraseListed( std::vector<Entity>& list, std::vector<int>& positions, Entity id )
+    {
+        if( id >= positions.size() || positions[id] < 0 )
+            return false;
+
+        size_t index = positions[id];
+
+        list[index] = list.back();
+        positions[list[index]] = (int)index;
+
+        list.pop_back();
+        positions[id] = -1;
+
+        return true;
+    }
 }
@@ -7,20 +7,139 @@
 
 namespace Core
 {
+    /*!
+        Returns the sort key of an entity, typically read from one of its components
+        like a material id, cell or lod level. Implemented where the EntityHandler is known,
+        context is the pointer given to SetSortKey, for example the EntityHandler of the world.
+    */
+    typedef uint32_t (*SortKeyFunction)( Entity id, void *context );
+
+    /*!
+        A range of sorted entities sharing the same key.
+    */
+    struct EntityGroup
+    {
+        uint32_t key;
+        size_t begin;
+        size_t count;
+    };
+
     class BaseSystem;
     class EntityBag
     {
     public:
-        EntityBag( Aspect inclusive, Aspect exclusive );
+        /*!
+            Creates a bag for entities matching the aspects. 
+            With trackChanges the bag also records which entities joined and left it,
+            see GetAdded and GetRemoved.
+        */
+        EntityBag( Aspect inclusive, Aspect exclusive, bool trackChanges = false );
         void ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp );
+
+        /*!
+            Batched ChangedEntity, entities without a previous aspect are appended in one go.
+        */
+        void ChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp );
         bool AspectMatch( Aspect asp );
 
+        /*!
+            Returns true if the entity is in the bag, in constant time.
+        */
+        bool Contains( Entity id );
+
+        /*!
+            Iteration cursor, an index into m_entities used by systems that
+            iterate the bag over several frames. Entities before the cursor stay before it
+            when others leave the bag, so every entity is visited once per pass.
+            New entities are appended after it.
+        */
+        size_t GetCursor() { return m_cursor; }
+        void SetCursor( size_t cursor ) { m_cursor = cursor; }
+
+        /*!
+            Entities that joined the bag since the last ClearChanges, in order unless some of them
+            left again, those are swap removed. Only recorded for bags tracking changes.
+        */
+        const std::vector<Entity>& GetAdded() { return m_added; }
+
+        /*!
+            Entities that left the bag since the last ClearChanges.
+            An entity that joined and left in the same period is in neither list,
+            entities that left may already have been destroyed.
+
+            An entity that left and joined again is in both lists, as its id may have been
+            reused by a new entity. Handle GetRemoved before GetAdded.
+        */
+        const std::vector<Entity>& GetRemoved() { return m_removed; }
+
+        /*!
+            Empties the added and removed lists, called by the SystemHandler after the
+            owning system has been updated.
+        */
+        void ClearChanges();
+
+        /*!
+            Enables a sorted view of the bag, ordered and grouped by the key returned by keyFunction.
+            m_entities keeps its order, the view is kept separately and updated by Sort.
+            context is passed to every call of keyFunction.
+        */
+        void SetSortKey( SortKeyFunction keyFunction, void *context = nullptr );
+
+        /*!
+            Brings the sorted view up to date. Keys aren't tracked between calls, so every Sort
+            reads the key of every entity in the bag, O(n) even when nothing changed.
+            Only entities that joined or whose key changed are radix sorted and merged into the view.
+        */
+        void Sort();
+
+        /*!
+            Entities sorted by key as of the last Sort.
+        */
+        const std::vector<Entity>& GetSortedEntities() { return m_sortedEntities; }
+
+        /*!
+            Ranges of GetSortedEntities sharing the same key, in key order.
+        */
+        const std::vector<EntityGroup>& GetGroups() { return m_groups; }
+
+        /*!
+            Entities in the bag. Entities leaving are swap removed in constant time, 
+            so the order is not kept.
+        */
         std::vector<Entity> m_entities;
 
     private:
+        void Insert( Entity id );
+        bool Remove( Entity id );
+        void SetIndex( Entity id, int index );
+        void SortJoined( Entity id );
+        void SortLeft( Entity id );
+
+        /*!
+            Appends to or swap removes from a list of unique entities, positions holds
+            the index of each entity in the list or -1, so both are constant time.
+        */
+        static void PushListed( std::vector<Entity>& list, std::vector<int>& positions, Entity id );
+        static bool EraseListed( std::vector<Entity>& list, std::vector<int>& positions, Entity id );
 
         Aspect m_inclusive;
         Aspect m_exclusive;
+        size_t m_cursor;
+        std::vector<int> m_index;
+
+        bool m_trackChanges;
+        std::vector<Entity> m_added;
+        std::vector<int> m_addedIndex;
+        std::vector<Entity> m_removed;
+
+        SortKeyFunction m_sortKey;
+        void *m_sortContext;
+        std::vector<Entity> m_sortedEntities;
+        std::vector<uint32_t> m_sortedKeys;
+        std::vector<EntityGroup> m_groups;
+        std::vector<Entity> m_sortJoined;
+        std::vector<int> m_sortJoinedIndex;
+        std::vector<Entity> m_sortLeft;
     };
 }
 
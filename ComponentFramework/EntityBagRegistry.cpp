@@ -0,0 +1,46 @@
+#include "EntityBagRegistry.hpp"
+
+namespace Core
+{
+    EntityBagRegistry::EntityBagRegistry()
+    {
+    }
+
+    EntityBagRegistry::~EntityBagRegistry()
+    {
+        for( size_t i = 0; i < m_bags.size(); i++ )
+            delete m_bags[i];
+    }
+
+    EntityBag* EntityBagRegistry::Intern( Aspect inclusive, Aspect exclusive )
+    {
+        for( size_t i = 0; i < m_keys.size(); i++ )
+        {
+            if( m_keys[i].inclusive == inclusive && m_keys[i].exclusive == exclusive )
+                return m_bags[i];
+        }
+
+        Key key = { inclusive, exclusive };
+        m_keys.push_back( key );
+        m_bags.push_back( new EntityBag( inclusive, exclusive ) );
+
+        return m_bags.back();
+    }
+
+    void EntityBagRegistry::ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp )
+    {
+        for( size_t i = 0; i < m_bags.size(); i++ )
+            m_bags[i]->ChangedEntity( id, old_asp, new_asp );
+    }
+
+    void EntityBagRegistry::ChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp )
+    {
+        for( size_t i = 0; i < m_bags.size(); i++ )
+            m_bags[i]->ChangedEntities( ids, count, old_asp, new_asp );
+    }
+
+    size_t EntityBagRegistry::GetBagCount()
+    {
+        return m_bags.size();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_ENTITYBAGREGISTRY_H
+#define SRC_CORE_COMPONENTFRAMEWORK_ENTITYBAGREGISTRY_H
+
+#include "SystemTypes.hpp"
+#include "EntityBag.hpp"
+
+#include <vector>
+
+namespace Core
+{
+    /*!
+        EntityBagRegistry, owned by the SystemHandler. Interns bags by their 
+        inclusive and exclusive aspects so systems filtering on the same components 
+        share one bag, which is updated once per change no matter how many systems use it.
+
+        Shared bags are plain bags, they don't track changes, sort or keep a cursor, 
+        systems needing that keep private bags in m_bags.
+    */
+    class EntityBagRegistry
+    {
+    public:
+        EntityBagRegistry();
+        ~EntityBagRegistry();
+
+        /*!
+            Returns the shared bag for the aspects, creating it if it doesn't exist yet.
+            The bag lives as long as the registry.
+        */
+        EntityBag* Intern( Aspect inclusive, Aspect exclusive );
+
+        void ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp );
+        void ChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp );
+
+        size_t GetBagCount();
+
+    private:
+        struct Key
+        {
+            Aspect inclusive;
+            Aspect exclusive;
+        };
+
+        EntityBagRegistry( const EntityBagRegistry& );
+        EntityBagRegistry& operator=( const EntityBagRegistry& );
+
+        std::vector<Key> m_keys;
+        std::vector<EntityBag*> m_bags;
+    };
+}
+
+#endif
@@ -3,13 +3,29 @@
 
 #include "PVector.hpp"
 #include "EntityVector.hpp"
+#include "EntityHierarchy.hpp"
+#include "ComponentTraits.hpp"
+#include "Prefab.hpp"
+#include "EntityStream.hpp"
+#include "WorkloadTrace.hpp"
+#include "SharedWorldRegion.hpp"
+#include "ComponentRegistry.hpp"
+#include "ColdStore.hpp"
+#include "Prefetch.hpp"
 #include <TemplateUtility/TemplateIndex.hpp>
 #include <TemplateUtility/TemplatePresence.hpp>
+#include <TemplateUtility/IndexSequence.hpp>
+#include <Timer.hpp>
 
 #include <cstdint>
+#include <cstring>
 #include <cassert>
 #include <array>
 #include <limits>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <chrono>
 
 #define SA_COMPONENT_USE "Component doesn't exist in EntityHandler. Maybe you forgot to add it?"
 
@@ -24,25 +40,122 @@ namespace Core
     class EntityHandlerTemplate
     {
     private:
-        static const int COMPONENT_COUNT = sizeof...(Components);
-
         std::array<void*,sizeof...(Components)> m_compDefaults = {{new Components()...}};
 
         EntityVector<1024,64,Components...> m_entities;
 
-        std::array<PVector*,sizeof...(Components)> m_components = {{new PVector(1024,64,sizeof(Components))...}};
+        std::array<PVector*,sizeof...(Components)> m_components = {{new PVector(1024,64,sizeof(Components),DoubleBuffered<Components>::value)...}};
+        EntityHierarchy m_hierarchy;
+        std::vector<unsigned char> m_disabled;
         SystemHandlerT *m_systemHandler;
+        WorkloadRecorder *m_recorder;
+        int m_trimType;
+        ComponentRegistry m_registry;
+        ColdStore m_cold;
+        std::vector<unsigned char> m_coldData;
+        std::vector<unsigned char> m_coldReference;
     public:
+        typedef SystemHandlerT SystemHandler;
+
+        static const int COMPONENT_COUNT = sizeof...(Components);
 
         // order: Name, count, alloc count, data used, data allocated
         typedef std::tuple<const char*,int,int,int,int> NameCountAllocTuple;
         typedef std::array<NameCountAllocTuple,COMPONENT_COUNT+1> EntityDataUseList;
 
+        /*!
+            SpawnBlock, stages entity creation on a worker thread, see BeginSpawnBlock.
+            Each thread uses its own block, blocks never touch the handlers storage
+            until they are committed with CommitSpawnBlock.
+        */
+        class SpawnBlock
+        {
+        public:
+            SpawnBlock()
+            {
+                m_handler = nullptr;
+                m_next = 0;
+                m_end = 0;
+                m_chunk = 0;
+            }
+
+            /*!
+                Stages an entity with the given components and returns its final id. 
+                The id may be stored, for example in a component of another spawned entity, 
+                but can't be passed to the handler until the block is committed.
+                Returns INVALID_ENTITY and stages nothing once a fixed reservation is used up.
+            */
+            template<typename... EntityComponents>
+            Entity Create( EntityComponents... c )
+            {
+                assert( m_handler != nullptr );
+
+                if( m_next == m_end )
+                {
+                    //Blocks with a fixed reservation have deterministic idn and never refill
+                    if( m_chunk == 0 )
+                        return INVALID_ENTITY;
+
+                    m_next = m_handler->m_entities.Reserve( m_chunk );
+                    m_end = m_next + (Entity)m_chunk;
+                }
+
+                Entry entry = { m_next++, GenerateAspect<EntityComponents...>() };
+                m_entries.push_back( entry );
+
+                StageT<EntityComponents...>( c... );
+
+                return entry.id;
+            }
+
+            /*!
+                Returns the number of entities staged.
+            */
+            size_t GetCount()
+            {
+                return m_entries.size();
+            }
+
+        private:
+            friend class EntityHandlerTemplate;
+
+            struct Entry
+            {
+                Entity id;
+                Aspect asp;
+            };
+
+            template<typename Component, typename... RComponents>
+            void StageT( Component comp, RComponents... r )
+            {
+                StageT<Component>( comp );
+                StageT<RComponents...>( r... );
+            }
+
+            template<typename Component>
+            void StageT( Component comp )
+            {
+                const unsigned char *bytes = (const unsigned char*)&comp;
+                std::vector<unsigned char>& data = m_data[GetComponentType<Component>()];
+
+                data.insert( data.end(), bytes, bytes + sizeof( Component ) );
+            }
+
+            EntityHandlerTemplate *m_handler;
+            Entity m_next;
+            Entity m_end;
+            size_t m_chunk;
+            std::vector<Entry> m_entries;
+            std::array<std::vector<unsigned char>,COMPONENT_COUNT> m_data;
+        };
+
     public:
 
         EntityHandlerTemplate( SystemHandlerT *systemHandler)
         {
             m_systemHandler = systemHandler;
+            m_recorder = nullptr;
+            m_trimType = 0;
         }
 
         ~EntityHandlerTemplate()
@@ -62,6 +175,9 @@ namespace Core
 
             AddComponentT<EntityComponents...>( ent, c... );
 
+            if( m_recorder != nullptr )
+                m_recorder->RecordCreate( ent, GenerateAspect<EntityComponents...>() );
+
             m_systemHandler->CallChangedEntity( ent, 0ULL, GenerateAspect<EntityComponents...>() );
             return ent;
         }
@@ -70,220 +186,1610 @@ namespace Core
         {
             Entity ent = m_entities.Alloc();        
 
+            if( m_recorder != nullptr )
+                m_recorder->RecordCreate( ent, 0ULL );
+
             return ent;
         }
 
-        Entity CopyEntity( Entity ent )
+        /*!
+            Prepares a block for spawning entities from a worker thread, call from the main thread.
+
+            With reserve set, the block gets exactly that many idn right away, so preparing 
+            blocks in a fixed order and committing them in the same order gives the same idn and 
+            component slots every run. Otherwise the block reserves chunk idn at a time as it needs them, 
+            lock-free, in whatever order the threads get there.
+        */
+        void BeginSpawnBlock( SpawnBlock& block, size_t reserve = 0, size_t chunk = 256 )
         {
-            Entity entCopy = CreateEntity();
+            assert( block.m_handler == nullptr );
+            assert( reserve > 0 || chunk > 0 );
 
-            Aspect oldAsp = GetEntityAspect( ent );
+            block.m_handler = this;
+            block.m_chunk = reserve > 0 ? 0 : chunk;
+            block.m_next = 0;
+            block.m_end = 0;
+
+            if( reserve > 0 )
+            {
+                block.m_next = m_entities.Reserve( reserve );
+                block.m_end = block.m_next + (Entity)reserve;
+            }
+        }
+
+        /*!
+            Creates the staged entities of a block, call from the main thread once the worker is done.
+            Components are allocated in bulk per type and systems are informed with one batched 
+            call per aspect. Reserved idn that weren't used are released and the block can be begun again.
+        */
+        void CommitSpawnBlock( SpawnBlock& block )
+        {
+            assert( block.m_handler == this );
+
+            std::vector<typename SpawnBlock::Entry>& entries = block.m_entries;
+            size_t count = entries.size();
+
+            for( size_t e = 0; e < count; e++ )
+            {
+                m_entities.CommitReserved( entries[e].id );
+            }
 
-            AddComponentsAspect( entCopy, oldAsp );
+            std::vector<int> compIds;
 
             for( int i = 0; i < COMPONENT_COUNT; i++ )
             {
-                if( ((1ULL << i) & oldAsp) != 0 )
+                if( block.m_data[i].size() == 0 )
+                    continue;
+
+                size_t typesize = m_components[i]->GetTypeSize();
+                size_t n = block.m_data[i].size() / typesize;
+
+                compIds.resize( n );
+                m_components[i]->AllocBulk( n, nullptr, &compIds[0] );
+
+                size_t k = 0;
+                for( size_t e = 0; e < count; e++ )
                 {
-                    int componentId = m_entities.GetComponentId(ent, i);
+                    if( ((entries[e].asp >> i) & 1ULL) == 0 )
+                        continue;
 
-                    if( componentId >= 0 )
-                    {
-                        m_components[i]->Set( entCopy, m_components[i]->Get(componentId) );
-                    }
+                    m_components[i]->Init( compIds[k], &block.m_data[i][k * typesize] );
+                    m_entities.SetComponentId( entries[e].id, compIds[k], i );
+                    k++;
                 }
             }
 
-            return entCopy;
-        }
+            std::vector<std::pair<Aspect,Entity>> order( count );
+            for( size_t e = 0; e < count; e++ )
+            {
+                order[e] = std::pair<Aspect,Entity>( entries[e].asp, entries[e].id );
+            }
+            std::sort( order.begin(), order.end() );
 
-        /*!
-            Template component adding function, will trigger
-            aspect updates to inform systems that the entity has changed.
-        */
-        template<typename... EntityComponents>
-        void AddComponents( Entity ent, EntityComponents... comps  )
-        {
-            Aspect oldAsp = GetEntityAspect( ent );
+            std::vector<Entity> group;
 
-            AddComponentT<EntityComponents...>( ent, comps... );
+            for( size_t begin = 0; begin < count; )
+            {
+                Aspect asp = order[begin].first;
 
-            m_systemHandler->CallChangedEntity( ent, oldAsp, GetEntityAspect( ent ) );
-        }
+                group.clear();
+                while( begin < count && order[begin].first == asp )
+                    group.push_back( order[begin++].second );
 
-        bool HasComponent( Entity ent, ComponentType type )
-        {
-            return (GetEntityAspect( ent ) & (1ULL << type)) != 0;
+                if( m_recorder != nullptr )
+                    m_recorder->RecordCreateBulk( &group[0], group.size(), asp );
+
+                m_systemHandler->CallChangedEntities( &group[0], group.size(), 0ULL, asp );
+            }
+
+            for( Entity id = block.m_next; id < block.m_end; id++ )
+            {
+                m_entities.ReturnReserved( id );
+            }
+
+            block.m_handler = nullptr;
+            block.m_next = 0;
+            block.m_end = 0;
+            block.m_entries.clear();
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+                block.m_data[i].clear();
         }
 
         /*!
-            Template component adding function using runtime
-            ids, primarily to be used from scripting utilities
-
-            Triggers change call to systems. Doesn't set any default
-            value to new components, so they might reuse data that was previously releasesed.
+            Creates a new entity with a copy of all the components of ent.
+            For many copies of the same setup, see CreatePrefab. 
+            The copy of a frozen entity is enabled and hot, ent stays frozen.
         */
-        void AddComponentsAspect( Entity ent, Aspect asp )
+        Entity CopyEntity( Entity ent )
         {
-            Aspect oldAsp = GetEntityAspect( ent );
+            Entity entCopy = m_entities.Alloc();
+
+            Aspect asp = GetEntityAspect( ent );
+
+            LoadFrozen( ent, m_coldData );
+            size_t coldOffset = 0;
 
             for( int i = 0; i < COMPONENT_COUNT; i++ )
             {
-                if( ((asp >> i) & 1ULL) > 0 )
+                const void *source = GetComponentSource( ent, i, m_coldData, coldOffset );
+
+                if( source != nullptr )
                 {
-                    AddComponent( ent, i );
+                    int copyId = m_components[i]->Alloc( nullptr );
+
+                    m_components[i]->Init( copyId, source );
+                    m_entities.SetComponentId( entCopy, copyId, i );
                 }
             }
 
-            m_systemHandler->CallChangedEntity( ent, oldAsp, GetEntityAspect( ent ) );
+            if( m_recorder != nullptr )
+                m_recorder->RecordCopy( ent, entCopy );
+
+            m_systemHandler->CallChangedEntity( entCopy, 0ULL, asp );
+
+            return entCopy;
         }
 
         /*!
-            Removes listed components from entity
+            Captures the given components and their values in a prefab.
         */
-        template<typename... EntityComponents>
-        void RemoveComponents( Entity ent )
+        template<typename... PrefabComponents>
+        Prefab CreatePrefab( PrefabComponents... c )
         {
-            RemoveComponentsAspect( ent, GenerateAspect<EntityComponents...>() );
-        }  
+            Prefab prefab;
+            SetPrefabComponentT<PrefabComponents...>( prefab, c... );
+            return prefab;
+        }
 
         /*!
-            Removes listed components from entity
+            Captures the current components and values of an entity in a prefab.
         */
-        void RemoveComponentsAspect( Entity ent, Aspect asp )
+        Prefab CreatePrefabFromEntity( Entity ent )
         {
-            Aspect oldAsp = GetEntityAspect( ent );
+            Prefab prefab;
+
+            LoadFrozen( ent, m_coldData );
+            size_t coldOffset = 0;
 
             for( int i = 0; i < COMPONENT_COUNT; i++ )
             {
-                if( ((asp >> i) & 1ULL) > 0 )
+                const void *source = GetComponentSource( ent, i, m_coldData, coldOffset );
+
+                if( source != nullptr )
                 {
-                    RemoveComponent( ent, i );
+                    prefab.SetComponentData( i, source, m_components[i]->GetTypeSize() );
                 }
             }
 
-            m_systemHandler->CallChangedEntity( ent, oldAsp, GetEntityAspect( ent ) );
+            return prefab;
         }
 
         /*!
-            Release an entity from allocation. Entity idn are reused, so make sure to never reference
-            an entity after calling this function as the old id might end up pointing to a new one.
+            Creates a prefab of the components in the aspect with their default values.
         */
-        bool DestroyEntity( Entity id )
+        Prefab CreatePrefabFromAspect( Aspect asp )
         {
-			// TODO: fix why this row is generating a compiler error.
-            //assert( std::numeric_limits<Entity>::max() != id );
+            Prefab prefab;
 
-            m_systemHandler->CallChangedEntity( id, GetEntityAspect( id ), 0ULL );
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( ((asp >> i) & 1ULL) > 0 )
+                {
+                    prefab.SetComponentData( i, m_compDefaults[i], m_components[i]->GetTypeSize() );
+                }
+            }
 
-            ClearComponents( id );
-            m_entities.Release( id );
-            
-            return true;
+            return prefab;
         }
 
         /*!
-            Retrieves entities current aspect
+            Returns the prefabs default value for Component, or nullptr if it isn't part of the prefab.
         */
-        Aspect GetEntityAspect( Entity id )
+        template<typename Component>
+        static Component* GetPrefabComponent( Prefab& prefab )
         {
-            return m_entities.GetAspect( id );
+            return (Component*)prefab.GetComponentData( GetComponentType<Component>() );
         }
 
         /*!
-            Returns the static type id of the given component, used mainly internally.
-            Calculated in compile-time making this function basically "free"
+            Creates count entities from the prefab and writes their ids to out.
+            Each component type is allocated and filled as a block, and systems 
+            are informed of all new entities in a single batched call.
         */
-        template<typename Component>
-        static ComponentType GetComponentType( )
+        void InstantiatePrefab( const Prefab& prefab, size_t count, Entity *out )
         {
-            #ifndef __GNUG__ //Sadly the gnucompiler hasn't implemented this yet =(
-            static_assert( std::is_trivially_copyable<Component>::value, "Components must be Pure Data Objects" );
-            #endif
-            static_assert( COMPONENT_COUNT < 64, "There is currently a limit of 64 components" );
-            static_assert( Match<Component,Components...>::exists, SA_COMPONENT_USE );
-            return Index<Component,std::tuple<Components...>>::value;
-        }
-    
-        /*!
-            Returns a pointer to component. The pointer is invalidated as soon as 
-            a manipulating function is called (like release component or add component).
-            or anything that might trigger a sorting of the component lists. This function 
-            does not trigger any of these.
-        */
-        template<typename Component>
-		Component* GetComponentTmpPointer(Entity entity)
-		{
-			static_assert(Match<Component, Components...>::exists, SA_COMPONENT_USE);
+            if( count == 0 )
+                return;
 
-			static const int componentType = GetComponentType<Component>();
+            m_entities.AllocBulk( count, out );
 
-            if(entity != INVALID_ENTITY )
+            std::vector<int> ids( count );
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
             {
-			    int componentId = m_entities.GetComponentId(entity, componentType);
+                const void *data = prefab.GetComponentData( i );
 
-                if( componentId >= 0 )
+                if( data != nullptr )
                 {
-                    return (Component*)m_components[componentType]->Get(componentId);
+                    m_components[i]->AllocBulk( count, data, &ids[0] );
+
+                    for( size_t j = 0; j < count; j++ )
+                    {
+                        m_entities.SetComponentId( out[j], ids[j], i );
+                    }
                 }
             }
 
-            return nullptr;
+            if( m_recorder != nullptr )
+                m_recorder->RecordCreateBulk( out, count, prefab.GetAspect() );
+
+            m_systemHandler->CallChangedEntities( out, count, 0ULL, prefab.GetAspect() );
         }
 
         /*!
-            Generates an aspect for the given group of components. An aspect is a generic single bitmask
-            representing a group of components. This aspect can be used for either inclusive or 
-            exclusive filtering. 
+            Moves entities with all their components to another EntityHandler of the same type,
+            typically the handler of another world. out receives the new ids in dest, in the same order.
+            Entities are moved in groups sharing the same aspect, so each group is allocated in bulk
+            and both handlers inform their systems with one batched call per group.
+
+            Parent links of the moved entities are not carried over,
+            disabled entities are enabled before they are moved.
+            Neither handler may be in use by another thread during the call.
 
-            This function is calculated in compile-time making this function "free". 
+            All entities leave this handler before dest informs its systems, systems that look up
+            their world through WorldTemplate::GetCurrent should migrate through WorldTemplate::MigrateEntities.
         */
-        template<typename... AspectComponents>
-        static Aspect GenerateAspect( )
+        void MigrateEntities( const Entity *ids, size_t count, EntityHandlerTemplate& dest, Entity *out )
         {
-            static const size_t ids[] = { GetComponentType<AspectComponents>()... };
-            return GenerateAspect( ids, Aspect(), 0, sizeof...(AspectComponents) ); 
+            MigrateEntities( ids, count, dest, out, [](){} );
         }
 
-        inline static Aspect GenerateAspect( ComponentType componentType )
+        /*!
+            MigrateEntities, with beforeDest() called once after the entities left this handler
+            and before dest informs its systems, for example to make the world of dest current.
+        */
+        template<typename Function>
+        void MigrateEntities( const Entity *ids, size_t count, EntityHandlerTemplate& dest, Entity *out, Function beforeDest )
         {
-            return 1ULL << componentType;
-        }
+            assert( &dest != this );
 
-        int GetEntityCount()
-        {
-            return m_entities.GetCount();
-        } 
-        
-        int GetComponentCount()
-        {
-            int all = 0;
-            
-            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            SetEnabled( ids, count, true );
+
+            std::vector<std::pair<Aspect,size_t>> order( count );
+            for( size_t i = 0; i < count; i++ )
             {
-                all += m_components[i]->GetCount();
+                order[i] = std::pair<Aspect,size_t>( GetEntityAspect( ids[i] ), i );
+            }
+            std::sort( order.begin(), order.end() );
+
+            std::vector<Entity> srcGroup;
+            std::vector<Entity> moved( count );
+            std::vector<int> compIds;
+
+            for( size_t begin = 0; begin < count; )
+            {
+                Aspect asp = order[begin].first;
+
+                size_t end = begin;
+                while( end < count && order[end].first == asp )
+                    end++;
+
+                size_t n = end - begin;
+
+                srcGroup.resize( n );
+                compIds.resize( n );
+
+                Entity *destGroup = &moved[begin];
+
+                for( size_t j = 0; j < n; j++ )
+                    srcGroup[j] = ids[order[begin+j].second];
+
+                dest.m_entities.AllocBulk( n, destGroup );
+
+                for( int i = 0; i < COMPONENT_COUNT; i++ )
+                {
+                    if( ((asp >> i) & 1ULL) == 0 )
+                        continue;
+
+                    dest.m_components[i]->AllocBulk( n, nullptr, &compIds[0] );
+
+                    for( size_t j = 0; j < n; j++ )
+                    {
+                        int srcId = m_entities.GetComponentId( srcGroup[j], i );
+
+                        dest.m_components[i]->Init( compIds[j], m_components[i]->GetAddress( srcId ) );
+                        dest.m_entities.SetComponentId( destGroup[j], compIds[j], i );
+                    }
+                }
+
+                m_systemHandler->CallChangedEntities( &srcGroup[0], n, asp, 0ULL );
+
+                for( size_t j = 0; j < n; j++ )
+                {
+                    if( m_recorder != nullptr )
+                        m_recorder->RecordDestroy( srcGroup[j] );
+
+                    m_hierarchy.RemoveEntity( srcGroup[j] );
+                    ClearComponents( srcGroup[j] );
+                    m_entities.Release( srcGroup[j] );
+
+                    out[order[begin+j].second] = destGroup[j];
+                }
+
+                begin = end;
+            }
+
+            beforeDest();
+
+            for( size_t begin = 0; begin < count; )
+            {
+                Aspect asp = order[begin].first;
+
+                size_t end = begin;
+                while( end < count && order[end].first == asp )
+                    end++;
+
+                if( dest.m_recorder != nullptr )
+                    dest.m_recorder->RecordCreateBulk( &moved[begin], end - begin, asp );
+
+                dest.m_systemHandler->CallChangedEntities( &moved[begin], end - begin, 0ULL, asp );
+
+                begin = end;
             }
-            return all;
         }
 
-        template<typename Component>
-        NameCountAllocTuple GetComponentUsage()
+        /*!
+            Appends all entities matching the aspects to out, by scanning the entity table.
+            Entities without any components and disabled entities are never matched.
+        */
+        void GetEntitiesMatching( Aspect inclusive, Aspect exclusive, std::vector<Entity>& out )
         {
-            PVector* pvec = m_components[GetComponentType<Component>()];
+            size_t range = m_entities.GetIdRange();
 
-            return NameCountAllocTuple( Component::GetName(), pvec->GetCount(), pvec->GetAllocation(), pvec->GetMemoryUse(), pvec->GetMemoryAllocation() );
+            for( size_t i = 0; i < range; i++ )
+            {
+                Aspect asp = GetEntityAspect( (Entity)i );
+
+                if( asp != 0ULL && (asp & inclusive) == inclusive && (asp & exclusive) == 0ULL && IsEnabled( (Entity)i ) )
+                    out.push_back( (Entity)i );
+            }
         }
 
-        EntityDataUseList GetDataUse()
+        /*!
+            Writes the entities and their components to a compact block, see EntityBlockHeader.
+            Entities are stored grouped by aspect so they can be recreated in batches.
+            Frozen entities are decoded for the block and stay frozen.
+        */
+        void SerializeEntities( const Entity *ids, size_t count, std::vector<unsigned char>& block )
         {
-            return {{ NameCountAllocTuple( "Entity", m_entities.GetCount(), m_entities.GetAllocation(), m_entities.GetMemoryUse(), m_entities.GetMemoryAllocation() ), (GetComponentUsage<Components>())... }};
-        }
+            std::vector<std::pair<Aspect,Entity>> order( count );
+            for( size_t i = 0; i < count; i++ )
+            {
+                order[i] = std::pair<Aspect,Entity>( GetEntityAspect( ids[i] ), ids[i] );
+            }
+            std::sort( order.begin(), order.end() );
 
-    private:
+            std::vector<std::vector<unsigned char>> frozen( count );
+            std::vector<size_t> coldOffsets( count, 0 );
+
+            for( size_t e = 0; e < count; e++ )
+            {
+                LoadFrozen( order[e].second, frozen[e] );
+            }
+
+            EntityBlockHeader header = { ENTITY_BLOCK_MAGIC, ENTITY_BLOCK_VERSION, COMPONENT_COUNT, (uint32_t)count };
+
+            block.clear();
+            AppendBytes( block, &header, sizeof( header ) );
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                uint32_t size = (uint32_t)m_components[i]->GetTypeSize();
+                AppendBytes( block, &size, sizeof( size ) );
+            }
+
+            for( size_t e = 0; e < count; e++ )
+            {
+                AppendBytes( block, &order[e].first, sizeof( Aspect ) );
+            }
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                for( size_t e = 0; e < count; e++ )
+                {
+                    const void *source = GetComponentSource( order[e].second, i, frozen[e], coldOffsets[e] );
 
-        static Aspect GenerateAspect( const size_t *id, Aspect asp, int i, int size )
+                    if( source != nullptr )
+                        AppendBytes( block, source, m_components[i]->GetTypeSize() );
+                }
+            }
+        }
+
+        /*!
+            Serializes the entities to block and disables them, typically followed by 
+            handing the block to an EntityStreamer to write it to disk. The entities are only 
+            gone once CompleteEviction is called with the result reported by EntityStreamer::PopWritten.
+        */
+        void EvictEntities( const Entity *ids, size_t count, std::vector<unsigned char>& block )
+        {
+            SerializeEntities( ids, count, block );
+            SetEnabled( ids, count, false );
+        }
+
+        /*!
+            Finishes an eviction, destroying the entities if their block was written 
+            and enabling them again if it wasn't, so a failed write never loses them.
+        */
+        void CompleteEviction( const Entity *ids, size_t count, bool written )
+        {
+            if( written == false )
+            {
+                SetEnabled( ids, count, true );
+                return;
+            }
+
+            for( size_t i = 0; i < count; i++ )
+            {
+                DestroyEntity( ids[i] );
+            }
+        }
+
+        /*!
+            Returns true if the block was written by an EntityHandler with the same components.
+        */
+        bool IsCompatible( EntityBlockReader& reader )
+        {
+            const size_t sizes[] = { sizeof(Components)... };
+            return reader.IsCompatible( sizes, COMPONENT_COUNT );
+        }
+
+        /*!
+            Recreates up to maxCount entities from the reader and appends their new ids to out. 
+            Call once per frame until the reader is done to spread the work of a large block, 
+            each run of entities sharing an aspect is allocated in bulk and added to the bags in one batch.
+            Returns the number of entities created, 0 without reading anything if the block is malformed
+            or was written with different components, see IsCompatible.
+        */
+        size_t LoadEntities( EntityBlockReader& reader, size_t maxCount, std::vector<Entity>& out )
+        {
+            if( IsCompatible( reader ) == false )
+                return 0;
+
+            size_t begin = reader.GetPosition();
+            size_t end = std::min( begin + maxCount, reader.GetEntityCount() );
+
+            std::vector<int> compIds;
+
+            for( size_t runBegin = begin; runBegin < end; )
+            {
+                Aspect asp = reader.GetAspect( runBegin );
+
+                size_t runEnd = runBegin;
+                while( runEnd < end && reader.GetAspect( runEnd ) == asp )
+                    runEnd++;
+
+                size_t n = runEnd - runBegin;
+                size_t first = out.size();
+
+                out.resize( first + n );
+                compIds.resize( n );
+
+                m_entities.AllocBulk( n, &out[first] );
+
+                for( int i = 0; i < COMPONENT_COUNT; i++ )
+                {
+                    if( ((asp >> i) & 1ULL) == 0 )
+                        continue;
+
+                    m_components[i]->AllocBulk( n, nullptr, &compIds[0] );
+
+                    for( size_t j = 0; j < n; j++ )
+                    {
+                        m_components[i]->Init( compIds[j], reader.NextComponent( i ) );
+                        m_entities.SetComponentId( out[first+j], compIds[j], i );
+                    }
+                }
+
+                if( m_recorder != nullptr )
+                    m_recorder->RecordCreateBulk( &out[first], n, asp );
+
+                m_systemHandler->CallChangedEntities( &out[first], n, 0ULL, asp );
+
+                runBegin = runEnd;
+            }
+
+            reader.Advance( end - begin );
+
+            return end - begin;
+        }
+
+        /*!
+            Template component adding function, will trigger
+            aspect updates to inform systems that the entity has changed.
+        */
+        template<typename... EntityComponents>
+        void AddComponents( Entity ent, EntityComponents... comps  )
+        {
+            Promote( ent );
+
+            Aspect oldAsp = GetEntityAspect( ent );
+
+            AddComponentT<EntityComponents...>( ent, comps... );
+
+            if( m_recorder != nullptr )
+                m_recorder->RecordAdd( ent, GenerateAspect<EntityComponents...>() );
+
+            NotifyChangedEntity( ent, oldAsp, GetEntityAspect( ent ) );
+        }
+
+        bool HasComponent( Entity ent, ComponentType type )
+        {
+            return (GetEntityAspect( ent ) & (1ULL << type)) != 0;
+        }
+
+        /*!
+            Template component adding function using runtime
+            ids, primarily to be used from scripting utilities
+
+            Triggers change call to systems. Doesn't set any default
+            value to new components, so they might reuse data that was previously releasesed.
+        */
+        void AddComponentsAspect( Entity ent, Aspect asp )
+        {
+            Promote( ent );
+
+            Aspect oldAsp = GetEntityAspect( ent );
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( ((asp >> i) & 1ULL) > 0 )
+                {
+                    AddComponent( ent, i );
+                }
+            }
+
+            if( m_recorder != nullptr )
+                m_recorder->RecordAdd( ent, asp );
+
+            NotifyChangedEntity( ent, oldAsp, GetEntityAspect( ent ) );
+        }
+
+        /*!
+            Removes listed components from entity
+        */
+        template<typename... EntityComponents>
+        void RemoveComponents( Entity ent )
+        {
+            RemoveComponentsAspect( ent, GenerateAspect<EntityComponents...>() );
+        }  
+
+        /*!
+            Removes listed components from entity
+        */
+        void RemoveComponentsAspect( Entity ent, Aspect asp )
+        {
+            Promote( ent );
+
+            Aspect oldAsp = GetEntityAspect( ent );
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( ((asp >> i) & 1ULL) > 0 )
+                {
+                    RemoveComponent( ent, i );
+                }
+            }
+
+            if( m_recorder != nullptr )
+                m_recorder->RecordRemove( ent, asp );
+
+            NotifyChangedEntity( ent, oldAsp, GetEntityAspect( ent ) );
+        }
+
+        /*!
+            Returns the runtime description of the component types, built on first use.
+            Requires every component to have a static GetName(), fields are described with COMPONENT_FIELDS.
+        */
+        const ComponentRegistry& GetRegistry()
+        {
+            if( m_registry.GetCount() == 0 )
+            {
+                ComponentTypeInfo types[] = { ComponentTypeInfo{ Components::GetName(), GetComponentType<Components>(), sizeof( Components ), 
+                    DoubleBuffered<Components>::value, ComponentFields<Components>::Get() }... };
+
+                for( int i = 0; i < COMPONENT_COUNT; i++ )
+                    m_registry.Register( types[i] );
+            }
+
+            return m_registry;
+        }
+
+        /*!
+            Runtime typed bulk creation, primarily for scripting layers. Creates count entities with 
+            the components in asp and writes their ids to out. buffers holds one array of count components
+            for each component in asp, in type id order, where nullptr gives that component its default value.
+            Systems are informed of all new entities in a single batched call.
+        */
+        void CreateEntities( Aspect asp, size_t count, const void * const *buffers, Entity *out )
+        {
+            if( count == 0 )
+                return;
+
+            m_entities.AllocBulk( count, out );
+
+            std::vector<int> ids( count );
+            size_t buffer = 0;
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( ((asp >> i) & 1ULL) == 0 )
+                    continue;
+
+                const unsigned char *data = (const unsigned char*)buffers[buffer++];
+                PVector *pvec = m_components[i];
+
+                pvec->AllocBulk( count, data == nullptr ? m_compDefaults[i] : nullptr, &ids[0] );
+
+                for( size_t j = 0; j < count; j++ )
+                {
+                    m_entities.SetComponentId( out[j], ids[j], i );
+
+                    if( data != nullptr )
+                        pvec->Init( ids[j], data + j * pvec->GetTypeSize() );
+                }
+            }
+
+            if( m_recorder != nullptr )
+                m_recorder->RecordCreateBulk( out, count, asp );
+
+            m_systemHandler->CallChangedEntities( out, count, 0ULL, asp );
+        }
+
+        /*!
+            Copies the components in asp of count entities to buffers, laid out as for CreateEntities.
+            Components an entity lacks are written with their default value, as are those of frozen entities.
+            Returns the number of entities having all the components.
+        */
+        size_t ReadComponents( Aspect asp, const Entity *ids, size_t count, void * const *buffers )
+        {
+            std::vector<unsigned char> complete( count, 1 );
+            size_t buffer = 0;
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( ((asp >> i) & 1ULL) == 0 )
+                    continue;
+
+                unsigned char *data = (unsigned char*)buffers[buffer++];
+                PVector *pvec = m_components[i];
+                size_t typesize = pvec->GetTypeSize();
+
+                for( size_t j = 0; j < count; j++ )
+                {
+                    int componentId = m_entities.GetComponentId( ids[j], i );
+
+                    if( componentId >= 0 )
+                    {
+                        memcpy( data + j * typesize, pvec->GetAddress( componentId ), typesize );
+                    }
+                    else
+                    {
+                        memcpy( data + j * typesize, m_compDefaults[i], typesize );
+                        complete[j] = 0;
+                    }
+                }
+            }
+
+            return std::count( complete.begin(), complete.end(), 1 );
+        }
+
+        /*!
+            Overwrites the components in asp of count entities from buffers, laid out as for CreateEntities.
+            Components an entity lacks are skipped, as are frozen entities, no components are added.
+            Returns the number of entities having all the components.
+        */
+        size_t WriteComponents( Aspect asp, const Entity *ids, size_t count, const void * const *buffers )
+        {
+            std::vector<unsigned char> complete( count, 1 );
+            size_t buffer = 0;
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( ((asp >> i) & 1ULL) == 0 )
+                    continue;
+
+                const unsigned char *data = (const unsigned char*)buffers[buffer++];
+                PVector *pvec = m_components[i];
+                size_t typesize = pvec->GetTypeSize();
+
+                for( size_t j = 0; j < count; j++ )
+                {
+                    int componentId = m_entities.GetComponentId( ids[j], i );
+
+                    if( componentId >= 0 )
+                        pvec->Set( componentId, data + j * typesize );
+                    else
+                        complete[j] = 0;
+                }
+            }
+
+            return std::count( complete.begin(), complete.end(), 1 );
+        }
+
+        /*!
+            Copies one field of a component of count entities, packed, to out. 
+            Entities lacking the component or frozen get the fields default value.
+            Returns the number of entities having the component.
+        */
+        size_t ReadField( ComponentType type, const ComponentField& field, const Entity *ids, size_t count, void *out )
+        {
+            assert( type < (ComponentType)COMPONENT_COUNT && field.offset + field.size <= m_components[type]->GetTypeSize() );
+
+            unsigned char *data = (unsigned char*)out;
+            size_t found = 0;
+
+            for( size_t j = 0; j < count; j++ )
+            {
+                int componentId = m_entities.GetComponentId( ids[j], type );
+                const unsigned char *component = (const unsigned char*)m_compDefaults[type];
+
+                if( componentId >= 0 )
+                {
+                    component = (const unsigned char*)m_components[type]->GetAddress( componentId );
+                    found++;
+                }
+
+                memcpy( data + j * field.size, component + field.offset, field.size );
+            }
+
+            return found;
+        }
+
+        /*!
+            Overwrites one field of a component of count entities from packed values in data.
+            Entities lacking the component or frozen are skipped. Returns the number of entities having the component.
+        */
+        size_t WriteField( ComponentType type, const ComponentField& field, const Entity *ids, size_t count, const void *data )
+        {
+            assert( type < (ComponentType)COMPONENT_COUNT && field.offset + field.size <= m_components[type]->GetTypeSize() );
+
+            const unsigned char *values = (const unsigned char*)data;
+            size_t found = 0;
+
+            for( size_t j = 0; j < count; j++ )
+            {
+                int componentId = m_entities.GetComponentId( ids[j], type );
+
+                if( componentId >= 0 )
+                {
+                    unsigned char *component = (unsigned char*)m_components[type]->Get( componentId );
+                    memcpy( component + field.offset, values + j * field.size, field.size );
+                    found++;
+                }
+            }
+
+            return found;
+        }
+
+        /*!
+            Writes the component idn of count entities to out, -1 for entities lacking the component
+            and COLD_COMPONENT for frozen ones. Used to index a ComponentView.
+        */
+        void GetComponentIds( ComponentType type, const Entity *ids, size_t count, int *out )
+        {
+            assert( type < (ComponentType)COMPONENT_COUNT );
+
+            for( size_t j = 0; j < count; j++ )
+                out[j] = m_entities.GetComponentId( ids[j], type );
+        }
+
+        /*!
+            Returns a zero-copy view of the storage of a component type, invalidated like
+            GetComponentTmpPointer. Pass writable if data will be written through the view,
+            for double buffered components this marks every component as written this frame.
+        */
+        ComponentView GetComponentView( ComponentType type, bool writable )
+        {
+            assert( type < (ComponentType)COMPONENT_COUNT );
+
+            PVector *pvec = m_components[type];
+
+            ComponentView view;
+            view.data = writable ? pvec->GetBuffer() : (void*)pvec->GetAddress( 0 );
+            view.previous = pvec->GetPreviousBuffer();
+            view.typesize = pvec->GetTypeSize();
+            view.count = pvec->GetHighWater();
+
+            return view;
+        }
+
+        /*!
+            Release an entity from allocation. Entity idn are reused, so make sure to never reference
+            an entity after calling this function as the old id might end up pointing to a new one.
+        */
+        bool DestroyEntity( Entity id )
+        {
+			// TODO: fix why this row is generating a compiler error.
+            //assert( std::numeric_limits<Entity>::max() != id );
+
+            if( m_recorder != nullptr )
+                m_recorder->RecordDestroy( id );
+
+            NotifyChangedEntity( id, GetEntityAspect( id ), 0ULL );
+
+            m_hierarchy.RemoveEntity( id );
+            ClearComponents( id );
+            m_entities.Release( id );
+            m_cold.Erase( id );
+
+            if( id < m_disabled.size() )
+                m_disabled[id] = 0;
+            
+            return true;
+        }
+
+        /*!
+            Disables or enables an entity. A disabled entity keeps its components and data
+            but is taken out of every system list and bag, as if it had no components,
+            until it is enabled again. Both cost a single change call to the systems and 
+            no allocation, which makes it the cheap way to put sleeping entities aside.
+
+            Components can still be added to and removed from a disabled entity, 
+            the systems see the result when it is enabled.
+        */
+        void SetEnabled( Entity id, bool enabled )
+        {
+            if( IsEnabled( id ) == enabled )
+                return;
+
+            if( m_recorder != nullptr )
+                m_recorder->RecordEnable( id, enabled );
+
+            Aspect asp = GetEntityAspect( id );
+
+            if( enabled )
+            {
+                Promote( id );
+                m_disabled[id] = 0;
+                m_systemHandler->CallChangedEntity( id, 0ULL, asp );
+            }
+            else
+            {
+                m_systemHandler->CallChangedEntity( id, asp, 0ULL );
+
+                if( id >= m_disabled.size() )
+                    m_disabled.resize( m_entities.GetIdRange(), 0 );
+
+                m_disabled[id] = 1;
+            }
+        }
+
+        /*!
+            Disables or enables many entities, systems are informed 
+            with one batched call per aspect.
+        */
+        void SetEnabled( const Entity *ids, size_t count, bool enabled )
+        {
+            std::vector<std::pair<Aspect,Entity>> order;
+            order.reserve( count );
+
+            for( size_t i = 0; i < count; i++ )
+            {
+                if( IsEnabled( ids[i] ) != enabled )
+                    order.push_back( std::pair<Aspect,Entity>( GetEntityAspect( ids[i] ), ids[i] ) );
+            }
+            std::sort( order.begin(), order.end() );
+
+            if( enabled == false && order.size() > 0 )
+                m_disabled.resize( std::max( m_disabled.size(), m_entities.GetIdRange() ), 0 );
+
+            std::vector<Entity> group;
+
+            for( size_t begin = 0; begin < order.size(); )
+            {
+                Aspect asp = order[begin].first;
+
+                group.clear();
+                while( begin < order.size() && order[begin].first == asp )
+                    group.push_back( order[begin++].second );
+
+                for( size_t j = 0; j < group.size(); j++ )
+                {
+                    if( enabled )
+                        Promote( group[j] );
+
+                    m_disabled[group[j]] = enabled ? 0 : 1;
+
+                    if( m_recorder != nullptr )
+                        m_recorder->RecordEnable( group[j], enabled );
+                }
+
+                if( enabled )
+                    m_systemHandler->CallChangedEntities( &group[0], group.size(), 0ULL, asp );
+                else
+                    m_systemHandler->CallChangedEntities( &group[0], group.size(), asp, 0ULL );
+            }
+        }
+
+        bool IsEnabled( Entity id )
+        {
+            return id >= m_disabled.size() || m_disabled[id] == 0;
+        }
+
+        /*!
+            Moves entities to the cold tier. They are disabled and their components are compressed
+            against the component defaults and released, which keeps the hot storage dense.
+            Cold entities keep their aspect, parent links and id.
+
+            The component accessors treat a cold entity as lacking its components and never bring
+            it back, so reading one from several threads is safe. Thaw brings the components back
+            to hot storage but leaves the entity disabled, enabling it brings it back entirely.
+            Adding or removing components of a cold entity thaws it first.
+        */
+        void Freeze( const Entity *ids, size_t count )
+        {
+            SetEnabled( ids, count, false );
+
+            for( size_t e = 0; e < count; e++ )
+            {
+                Entity id = ids[e];
+
+                if( m_cold.Contains( id ) )
+                    continue;
+
+                m_coldData.clear();
+                m_coldReference.clear();
+
+                for( int i = 0; i < COMPONENT_COUNT; i++ )
+                {
+                    int componentId = m_entities.GetComponentId( id, i );
+
+                    if( componentId >= 0 )
+                    {
+                        AppendBytes( m_coldData, m_components[i]->GetAddress( componentId ), m_components[i]->GetTypeSize() );
+                        AppendBytes( m_coldReference, m_compDefaults[i], m_components[i]->GetTypeSize() );
+
+                        m_components[i]->Release( componentId );
+                        m_entities.SetComponentId( id, COLD_COMPONENT, i );
+                    }
+                }
+
+                m_cold.Store( id, m_coldData.data(), m_coldReference.data(), m_coldData.size() );
+            }
+        }
+
+        /*!
+            Brings the components of frozen entities back to hot storage, the entities stay disabled.
+            Does nothing for entities that aren't frozen.
+        */
+        void Thaw( const Entity *ids, size_t count )
+        {
+            for( size_t i = 0; i < count; i++ )
+            {
+                Promote( ids[i] );
+            }
+        }
+
+        bool IsFrozen( Entity id )
+        {
+            return m_cold.Contains( id );
+        }
+
+        /*!
+            Returns the number of frozen entities and the memory their compressed components use, in bytes.
+        */
+        size_t GetFrozenCount()
+        {
+            return m_cold.GetCount();
+        }
+
+        size_t GetFrozenMemoryUse()
+        {
+            return m_cold.GetMemoryUse();
+        }
+
+        /*!
+            Starts recording every structural change to recorder, nullptr stops recording.
+            The recorder isn't owned by the handler and has to outlive the recording.
+        */
+        void SetRecorder( WorkloadRecorder *recorder )
+        {
+            m_recorder = recorder;
+        }
+
+        /*!
+            Links child to parent. Reparenting moves the childs whole subtree.
+            Returns false if either entity doesn't exist or the link would create a cycle. 
+            When an entity is destroyed its children become roots.
+        */
+        bool SetParent( Entity child, Entity parent )
+        {
+            if( m_entities.IsAlive( child ) == false || m_entities.IsAlive( parent ) == false )
+                return false;
+
+            return m_hierarchy.SetParent( child, parent );
+        }
+
+        /*!
+            Removes the entities parent link, making it a root.
+        */
+        void ClearParent( Entity child )
+        {
+            m_hierarchy.ClearParent( child );
+        }
+
+        /*!
+            Returns the entities parent, or INVALID_ENTITY if it has none.
+        */
+        Entity GetParent( Entity child )
+        {
+            return m_hierarchy.GetParent( child );
+        }
+
+        /*!
+            Returns the depth sorted hierarchy, primarily for systems that want
+            to split the propagation of a level over several threads.
+        */
+        EntityHierarchy& GetHierarchy()
+        {
+            return m_hierarchy;
+        }
+
+        /*!
+            Propagates Component from parents to children, calling 
+            func( const Component& parent, Component& child ) one level at a time, top down.
+            Links where either entity lacks the component or is frozen are skipped.
+        */
+        template<typename Component, typename Function>
+        void PropagateHierarchy( Function func )
+        {
+            for( size_t i = 0; i < m_hierarchy.GetLevelCount(); i++ )
+            {
+                PropagateHierarchyLevel<Component>( i, 0, m_hierarchy.GetLevel( i ).size(), func );
+            }
+        }
+
+        /*!
+            Propagates Component over the links [begin,end) of a single level.
+            Ranges of the same level never touch the same child and can be run in parallel,
+            as long as all previous levels are done.
+        */
+        template<typename Component, typename Function>
+        void PropagateHierarchyLevel( size_t level, size_t begin, size_t end, Function func )
+        {
+            const std::vector<EntityHierarchy::Link>& links = m_hierarchy.GetLevel( level );
+
+            for( size_t i = begin; i < end; i++ )
+            {
+                Component* parent = GetComponentTmpPointer<Component>( links[i].parent );
+                Component* child = GetComponentTmpPointer<Component>( links[i].child );
+
+                if( parent != nullptr && child != nullptr )
+                {
+                    func( *parent, *child );
+                }
+            }
+        }
+
+        /*!
+            Retrieves entities current aspect
+        */
+        Aspect GetEntityAspect( Entity id )
+        {
+            return m_entities.GetAspect( id );
+        }
+
+        /*!
+            Returns the static type id of the given component, used mainly internally.
+            Calculated in compile-time making this function basically "free"
+        */
+        template<typename Component>
+        static constexpr ComponentType GetComponentType( )
+        {
+            #ifndef __GNUG__ //Sadly the gnucompiler hasn't implemented this yet =(
+            static_assert( std::is_trivially_copyable<Component>::value, "Components must be Pure Data Objects" );
+            #endif
+            static_assert( COMPONENT_COUNT < 64, "There is currently a limit of 64 components" );
+            static_assert( Match<Component,Components...>::exists, SA_COMPONENT_USE );
+            return Index<Component,std::tuple<Components...>>::value;
+        }
+    
+        /*!
+            Returns a pointer to component. The pointer is invalidated as soon as 
+            a manipulating function is called (like release component or add component).
+            or anything that might trigger a sorting of the component lists. This function 
+            does not trigger any of these. Returns nullptr if the entity lacks the component or is frozen.
+        */
+        template<typename Component>
+		Component* GetComponentTmpPointer(Entity entity)
+		{
+			static_assert(Match<Component, Components...>::exists, SA_COMPONENT_USE);
+
+			static const int componentType = GetComponentType<Component>();
+
+            if(entity != INVALID_ENTITY )
+            {
+			    int componentId = m_entities.GetComponentId(entity, componentType);
+
+                if( componentId >= 0 )
+                {
+                    return (Component*)m_components[componentType]->Get(componentId);
+                }
+            }
+
+            return nullptr;
+        }
+
+        /*!
+            Returns a handle to the entity that stays recognizable after the entity is destroyed
+            and its id reused, for references kept across frames. Returns an invalid handle,
+            { INVALID_ENTITY, 0 }, if no entity with the id exists.
+        */
+        EntityHandle GetHandle( Entity id )
+        {
+            EntityHandle handle = { INVALID_ENTITY, 0 };
+
+            if( m_entities.IsAlive( id ) )
+            {
+                handle.id = id;
+                handle.generation = m_entities.GetGeneration( id );
+            }
+
+            return handle;
+        }
+
+        /*!
+            Returns true if the entity of the handle still exists, a single compare.
+        */
+        bool IsValid( EntityHandle handle )
+        {
+            return m_entities.IsCurrent( handle.id, handle.generation );
+        }
+
+        /*!
+            Returns the entity of the handle, or INVALID_ENTITY if it no longer exists.
+        */
+        Entity Resolve( EntityHandle handle )
+        {
+            return IsValid( handle ) ? handle.id : INVALID_ENTITY;
+        }
+
+        /*!
+            Same as GetComponentTmpPointer for the entity of the handle, 
+            returns nullptr if the entity no longer exists.
+        */
+        template<typename Component>
+        Component* GetComponentTmpPointer( EntityHandle handle )
+        {
+            static const int componentType = GetComponentType<Component>();
+
+            if( m_entities.IsCurrent( handle.id, handle.generation ) == false )
+                return nullptr;
+
+            int componentId = m_entities.GetComponentId( handle.id, componentType );
+
+            if( componentId >= 0 )
+                return (Component*)m_components[componentType]->Get( componentId );
+
+            return nullptr;
+        }
+
+        /*!
+            Calls func( Entity, IterComponents&... ) for each of the entities having all the components,
+            entities lacking one or frozen are skipped. Equivalent to a loop over GetComponentTmpPointer
+            skipping entities where it returns nullptr, see Benchmarks/ForEachBenchmark.cpp, but the 
+            entities are handled in blocks where the component idn of the whole block are resolved first, 
+            prefetching the entity rows ahead, and the component data is then prefetched a few entities 
+            ahead of func. Pays off for large lists in scattered order, like a bag after some churn.
+            The components may not be added or removed by func.
+        */
+        template<typename... IterComponents, typename Function>
+        void ForEach( const Entity *ids, size_t count, Function func )
+        {
+            static_assert( sizeof...(IterComponents) > 0, "ForEach needs at least one component" );
+
+            const int N = sizeof...(IterComponents);
+            const int types[N] = { (int)GetComponentType<IterComponents>()... };
+
+            int compIds[N][FOREACH_BLOCK];
+            Entity block[FOREACH_BLOCK];
+
+            for( size_t begin = 0; begin < count; begin += FOREACH_BLOCK )
+            {
+                size_t n = std::min( (size_t)FOREACH_BLOCK, count - begin );
+                size_t valid = 0;
+
+                for( size_t j = 0; j < n; j++ )
+                {
+                    if( begin + j + FOREACH_ROW_AHEAD < count )
+                        CORE_PREFETCH( m_entities.GetRow( ids[begin + j + FOREACH_ROW_AHEAD] ) );
+
+                    Entity id = ids[begin + j];
+                    bool all = true;
+
+                    for( int t = 0; t < N; t++ )
+                    {
+                        compIds[t][valid] = m_entities.GetComponentId( id, types[t] );
+                        all = all && compIds[t][valid] >= 0;
+                    }
+
+                    if( all )
+                        block[valid++] = id;
+                }
+
+                for( size_t j = 0; j < valid && j < FOREACH_DATA_AHEAD; j++ )
+                {
+                    for( int t = 0; t < N; t++ )
+                        CORE_PREFETCH( m_components[types[t]]->GetAddress( compIds[t][j] ) );
+                }
+
+                for( size_t j = 0; j < valid; j++ )
+                {
+                    if( j + FOREACH_DATA_AHEAD < valid )
+                    {
+                        for( int t = 0; t < N; t++ )
+                            CORE_PREFETCH( m_components[types[t]]->GetAddress( compIds[t][j + FOREACH_DATA_AHEAD] ) );
+                    }
+
+                    InvokeForEach<IterComponents...>( func, block[j], compIds, j, typename MakeIndexSequence<sizeof...(IterComponents)>::type() );
+                }
+            }
+        }
+
+        template<typename... IterComponents, typename Function>
+        void ForEach( const std::vector<Entity>& ids, Function func )
+        {
+            if( ids.size() > 0 )
+                ForEach<IterComponents...>( &ids[0], ids.size(), func );
+        }
+
+        /*!
+            Returns a pointer to last frames data of a double buffered component,
+            which can be read without locks while other systems write the component 
+            through GetComponentTmpPointer. For other components this is the same data
+            as GetComponentTmpPointer. Invalidated like GetComponentTmpPointer and by SwapComponentBuffers.
+            Returns nullptr if the entity lacks the component or is frozen.
+        */
+        template<typename Component>
+        const Component* GetComponentReadPointer(Entity entity)
+        {
+            static const int componentType = GetComponentType<Component>();
+
+            if(entity != INVALID_ENTITY )
+            {
+                int componentId = m_entities.GetComponentId(entity, componentType);
+
+                if( componentId >= 0 )
+                {
+                    return (const Component*)m_components[componentType]->GetPrevious(componentId);
+                }
+            }
+
+            return nullptr;
+        }
+
+        /*!
+            Swaps the buffers of all double buffered components, 
+            call once at the frame boundary when no system is running.
+        */
+        void SwapComponentBuffers()
+        {
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                m_components[i]->Swap();
+            }
+        }
+
+        /*!
+            Generates an aspect for the given group of components. An aspect is a generic single bitmask
+            representing a group of components. This aspect can be used for either inclusive or 
+            exclusive filtering. 
+
+            This function is constexpr, so the aspect can be used as a compile-time constant. 
+        */
+        template<typename... AspectComponents>
+        static constexpr Aspect GenerateAspect( )
+        {
+            return AspectOr( (1ULL << GetComponentType<AspectComponents>())... ); 
+        }
+
+        inline static constexpr Aspect GenerateAspect( ComponentType componentType )
+        {
+            return 1ULL << componentType;
+        }
+
+        /*!
+            Compacts storage after many entities were destroyed. The highest used component slots 
+            are moved into the lowest free ones and the entities rows are updated, after which memory 
+            above the highest used slot is released, as are the rows of released entity idn at the end 
+            of the id range. Entity idn never change.
+
+            Works one component type at a time and stops once the budget is spent, 
+            call every frame until it returns true. Invalidates all component pointers, so it must 
+            not run while systems run or while spawn blocks are begun.
+        */
+        bool Trim( std::chrono::microseconds budget )
+        {
+            HighresTimer timer;
+            timer.Start();
+
+            std::vector<std::pair<int,int>> moves;
+            std::vector<int> remap;
+
+            while( m_trimType < COMPONENT_COUNT )
+            {
+                PVector *pvec = m_components[m_trimType];
+
+                moves.clear();
+                bool done = pvec->Compact( TRIM_MOVES, moves );
+
+                if( moves.size() > 0 )
+                {
+                    //The moves come from the top slots, so the first one is the highest
+                    remap.assign( moves[0].first + 1, -1 );
+                    for( size_t i = 0; i < moves.size(); i++ )
+                        remap[moves[i].first] = moves[i].second;
+
+                    size_t range = m_entities.GetIdRange();
+                    for( size_t e = 0; e < range; e++ )
+                    {
+                        int componentId = m_entities.GetComponentId( (Entity)e, m_trimType );
+
+                        if( componentId >= 0 && componentId < (int)remap.size() && remap[componentId] >= 0 )
+                            m_entities.SetComponentId( (Entity)e, remap[componentId], m_trimType );
+                    }
+                }
+
+                if( done )
+                    m_trimType++;
+
+                timer.Stop();
+                if( timer.GetDelta() >= budget && m_trimType < COMPONENT_COUNT )
+                    return false;
+            }
+
+            m_entities.Trim();
+
+            if( m_disabled.size() > m_entities.GetIdRange() )
+            {
+                m_disabled.resize( m_entities.GetIdRange() );
+                std::vector<unsigned char>( m_disabled ).swap( m_disabled );
+            }
+
+            m_trimType = 0;
+            return true;
+        }
+
+        /*!
+            Describes the storage of every component for SharedWorldRegion::Create,
+            in component type order, with room for capacity components of each type.
+        */
+        std::array<SharedComponentDesc,COMPONENT_COUNT> GetSharedLayout( size_t capacity )
+        {
+            return {{ SharedComponentDesc{ Components::GetName(), sizeof( Components ), DoubleBuffered<Components>::value, capacity }... }};
+        }
+
+        /*!
+            Returns the size in bytes of one row in the entity table.
+        */
+        static size_t GetSharedRowSize()
+        {
+            return COMPONENT_COUNT * sizeof( int );
+        }
+
+        /*!
+            Moves the component buffers and the entity table into a region created from
+            GetSharedLayout, after which they never reallocate. The capacities given to the region
+            become hard limits: creating more entity idn than entityCapacity, or more components of a type
+            than its capacity, aborts the process with a message, also in release builds. Size the region
+            for the peak, freed idn and components are reused. The region has to outlive the handler.
+            Returns false without moving anything if the region is too small or doesn't match.
+        */
+        bool ShareStorage( SharedWorldRegion& region )
+        {
+            assert( region.IsWriter() );
+
+            SharedWorldHeader *header = region.GetHeader();
+
+            if( header->componentCount != COMPONENT_COUNT || header->entityRowSize != GetSharedRowSize()
+                || header->entityCapacity < m_entities.GetIdRange() )
+                return false;
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                SharedComponentInfo *info = region.GetComponent( i );
+
+                if( info->typesize != m_components[i]->GetTypeSize() || ( info->doubleBuffered != 0 ) != m_components[i]->IsDoubleBuffered() 
+                    || info->capacity < m_components[i]->GetHighWater() )
+                    return false;
+            }
+
+            if( m_entities.SetExternalRows( (int*)region.GetData( header->entityOffset ), header->entityCapacity ) == false )
+                return false;
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                SharedComponentInfo *info = region.GetComponent( i );
+
+                bool moved = m_components[i]->SetExternalBuffers( region.GetData( info->currentOffset ), region.GetData( info->previousOffset ), info->capacity );
+                assert( moved );
+            }
+
+            PublishSharedStats( region );
+            return true;
+        }
+
+        /*!
+            Writes the entity and component counts to the region, 
+            call between SharedWorldRegion::BeginWrite and EndWrite.
+        */
+        void PublishSharedStats( SharedWorldRegion& region )
+        {
+            SharedWorldHeader *header = region.GetHeader();
+            header->entityRows = m_entities.GetIdRange();
+            header->entityCount = m_entities.GetCount();
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                SharedComponentInfo *info = region.GetComponent( i );
+                info->count = m_components[i]->GetCount();
+                info->highWater = m_components[i]->GetHighWater();
+            }
+        }
+
+        int GetEntityCount()
+        {
+            return m_entities.GetCount();
+        } 
+        
+        int GetComponentCount()
+        {
+            int all = 0;
+            
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                all += m_components[i]->GetCount();
+            }
+            return all;
+        }
+
+        template<typename Component>
+        NameCountAllocTuple GetComponentUsage()
+        {
+            PVector* pvec = m_components[GetComponentType<Component>()];
+
+            return NameCountAllocTuple( Component::GetName(), pvec->GetCount(), pvec->GetAllocation(), pvec->GetMemoryUse(), pvec->GetMemoryAllocation() );
+        }
+
+        EntityDataUseList GetDataUse()
+        {
+            return {{ NameCountAllocTuple( "Entity", m_entities.GetCount(), m_entities.GetAllocation(), m_entities.GetMemoryUse(), m_entities.GetMemoryAllocation() ), (GetComponentUsage<Components>())... }};
+        }
+
+    private:
+        static const size_t FOREACH_BLOCK = 128;
+        static const size_t FOREACH_ROW_AHEAD = 32;
+        static const size_t FOREACH_DATA_AHEAD = 16;
+        static const size_t TRIM_MOVES = 4096;
+
+        /*!
+            Decodes the components of a frozen entity to data, packed in component type order,
+            leaving the entity frozen. data is emptied for entities that aren't frozen.
+        */
+        void LoadFrozen( Entity id, std::vector<unsigned char>& data )
+        {
+            data.clear();
+
+            if( m_cold.Contains( id ) == false )
+                return;
+
+            m_coldReference.clear();
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( m_entities.GetComponentId( id, i ) == COLD_COMPONENT )
+                    AppendBytes( m_coldReference, m_compDefaults[i], m_components[i]->GetTypeSize() );
+            }
+
+            data.resize( m_coldReference.size() );
+            m_cold.Load( id, m_coldReference.data(), data.data(), data.size() );
+        }
+
+        /*!
+            Returns the data of a component for reading, from hot storage or from frozen as
+            decoded by LoadFrozen, or nullptr if the entity lacks it. Called for the component types 
+            of an entity in ascending order, coldOffset starting at 0.
+        */
+        const void* GetComponentSource( Entity id, int componentType, const std::vector<unsigned char>& frozen, size_t& coldOffset )
+        {
+            int componentId = m_entities.GetComponentId( id, componentType );
+
+            if( componentId >= 0 )
+                return m_components[componentType]->GetAddress( componentId );
+
+            if( componentId == COLD_COMPONENT )
+            {
+                const void *source = &frozen[coldOffset];
+                coldOffset += m_components[componentType]->GetTypeSize();
+                return source;
+            }
+
+            return nullptr;
+        }
+
+        /*!
+            Brings the components of a frozen entity back to hot storage, 
+            does nothing for other entities. The entity stays disabled.
+        */
+        void Promote( Entity id )
+        {
+            if( m_cold.Contains( id ) == false )
+                return;
+
+            LoadFrozen( id, m_coldData );
+            m_cold.Erase( id );
+
+            size_t offset = 0;
+
+            for( int i = 0; i < COMPONENT_COUNT; i++ )
+            {
+                if( m_entities.GetComponentId( id, i ) == COLD_COMPONENT )
+                {
+                    int componentId = m_components[i]->Alloc( nullptr );
+                    m_components[i]->Init( componentId, &m_coldData[offset] );
+                    m_entities.SetComponentId( id, componentId, i );
+
+                    offset += m_components[i]->GetTypeSize();
+                }
+            }
+        }
+
+        /*!
+            Informs the systems of a change, unless the entity is disabled
+            in which case the systems don't know about it.
+        */
+        void NotifyChangedEntity( Entity id, Aspect old_asp, Aspect new_asp )
+        {
+            if( IsEnabled( id ) )
+                m_systemHandler->CallChangedEntity( id, old_asp, new_asp );
+        }
+
+        template<typename... IterComponents, std::size_t... I, typename Function>
+        void InvokeForEach( Function& func, Entity id, int (*compIds)[FOREACH_BLOCK], size_t j, IndexSequence<I...> )
+        {
+            func( id, *(IterComponents*)m_components[GetComponentType<IterComponents>()]->Get( compIds[I][j] )... );
+        }
+
+        static void AppendBytes( std::vector<unsigned char>& block, const void *data, size_t size )
+        {
+            const unsigned char *bytes = (const unsigned char*)data;
+            block.insert( block.end(), bytes, bytes + size );
+        }
+
+        static constexpr Aspect AspectOr( )
+        {
+            return 0ULL;
+        }
+
+        template<typename... RAspects>
+        static constexpr Aspect AspectOr( Aspect asp, RAspects... r )
+        {
+            return asp | AspectOr( r... );
+        }
+
+        template<typename Component, typename... RComponents>
+        void SetPrefabComponentT( Prefab& prefab, Component comp, RComponents... r )
+        {
+            prefab.SetComponentData( GetComponentType<Component>(), &comp, sizeof( Component ) );
+
+            SetPrefabComponentT<RComponents...>( prefab, r... );
+        }
+
+        template<typename Component>
+        void SetPrefabComponentT( Prefab& prefab, Component comp )
         {
-            return asp |= (1ULL << id[i] | (i < size-1 ? GenerateAspect(id,asp,i+1,size) : 0ULL )); 
+            prefab.SetComponentData( GetComponentType<Component>(), &comp, sizeof( Component ) );
         }
 
         /*!
@@ -297,7 +1803,7 @@ namespace Core
 
             int compId = AddComponent( ent, componentType );
 
-            m_components[componentType]->Set( compId, &comp );
+            m_components[componentType]->Init( compId, &comp );
             
             AddComponentT<RComponents...>(ent, r...);
         }
@@ -313,7 +1819,7 @@ namespace Core
 
             int compId = AddComponent( ent, componentType );
             
-            m_components[componentType]->Set( compId, &comp );
+            m_components[componentType]->Init( compId, &comp );
         }
 
         /*!
@@ -0,0 +1,159 @@
+#include "EntityHierarchy.hpp"
+
+#include <cassert>
+
+namespace Core
+{
+    bool EntityHierarchy::SetParent( Entity child, Entity parent )
+    {
+        assert( child != INVALID_ENTITY && parent != INVALID_ENTITY );
+
+        //Refuse links that would make the child its own ancestor
+        for( Entity it = parent; it != INVALID_ENTITY; it = GetParent( it ) )
+        {
+            if( it == child )
+                return false;
+        }
+
+        DetachFromParent( child );
+
+        GetNode( child ).parent = parent;
+        GetNode( parent ).children.push_back( child );
+
+        SetDepth( child, GetNode( parent ).depth + 1 );
+
+        return true;
+    }
+
+    void EntityHierarchy::ClearParent( Entity child )
+    {
+        if( GetParent( child ) == INVALID_ENTITY )
+            return;
+
+        DetachFromParent( child );
+        SetDepth( child, 0 );
+    }
+
+    void EntityHierarchy::RemoveEntity( Entity id )
+    {
+        if( id >= m_nodes.size() )
+            return;
+
+        ClearParent( id );
+
+        std::vector<Entity> children;
+        children.swap( m_nodes[id].children );
+
+        for( size_t i = 0; i < children.size(); i++ )
+        {
+            m_nodes[children[i]].parent = INVALID_ENTITY;
+            SetDepth( children[i], 0 );
+        }
+    }
+
+    Entity EntityHierarchy::GetParent( Entity id )
+    {
+        if( id >= m_nodes.size() )
+            return INVALID_ENTITY;
+
+        return m_nodes[id].parent;
+    }
+
+    int EntityHierarchy::GetDepth( Entity id )
+    {
+        if( id >= m_nodes.size() )
+            return 0;
+
+        return m_nodes[id].depth;
+    }
+
+    const std::vector<Entity>& EntityHierarchy::GetChildren( Entity id )
+    {
+        if( id >= m_nodes.size() )
+            return m_noChildren;
+
+        return m_nodes[id].children;
+    }
+
+    size_t EntityHierarchy::GetLevelCount()
+    {
+        return m_levels.size();
+    }
+
+    const std::vector<EntityHierarchy::Link>& EntityHierarchy::GetLevel( size_t level )
+    {
+        assert( level < m_levels.size() );
+        return m_levels[level];
+    }
+
+    EntityHierarchy::Node& EntityHierarchy::GetNode( Entity id )
+    {
+        if( id >= m_nodes.size() )
+        {
+            Node root;
+            root.parent = INVALID_ENTITY;
+            root.depth = 0;
+            root.slot = -1;
+            m_nodes.resize( id + 1, root );
+        }
+
+        return m_nodes[id];
+    }
+
+    void EntityHierarchy::SetDepth( Entity id, int depth )
+    {
+        Node& node = m_nodes[id];
+
+        //Swap remove from the old level
+        if( node.depth > 0 )
+        {
+            std::vector<Link>& level = m_levels[node.depth-1];
+
+            level[node.slot] = level.back();
+            m_nodes[level[node.slot].child].slot = node.slot;
+            level.pop_back();
+
+            while( m_levels.size() > 0 && m_levels.back().size() == 0 )
+                m_levels.pop_back();
+        }
+
+        node.depth = depth;
+        node.slot = -1;
+
+        if( depth > 0 )
+        {
+            if( m_levels.size() < (size_t)depth )
+                m_levels.resize( depth );
+
+            Link link = { id, node.parent };
+            node.slot = (int)m_levels[depth-1].size();
+            m_levels[depth-1].push_back( link );
+        }
+
+        for( size_t i = 0; i < node.children.size(); i++ )
+        {
+            SetDepth( node.children[i], depth + 1 );
+        }
+    }
+
+    void EntityHierarchy::DetachFromParent( Entity child )
+    {
+        Entity parent = GetParent( child );
+
+        if( parent == INVALID_ENTITY )
+            return;
+
+        std::vector<Entity>& siblings = m_nodes[parent].children;
+        for( size_t i = 0; i < siblings.size(); i++ )
+        {
+            if( siblings[i] == child )
+            {
+                siblings[i] = siblings.back();
+                siblings.pop_back();
+                break;
+            }
+        }
+
+        m_nodes[child].parent = INVALID_ENTITY;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_ENTITYHIERARCHY_H
+#define SRC_CORE_COMPONENTFRAMEWORK_ENTITYHIERARCHY_H
+
+#include "SystemTypes.hpp"
+
+#include <vector>
+
+namespace Core
+{
+    /*!
+        EntityHierarchy, internal datastructure used by the EntityHandler
+        to store parent/child links between entities.
+
+        Every entity that has a parent is stored in a flat list for its depth,
+        level 0 holds the direct children of root entities, level 1 their children and so on.
+        Walking the levels in order guarantees that a parent is always visited before
+        its children, and entities within the same level never depend on each other.
+    */
+    class EntityHierarchy
+    {
+    public:
+        struct Link
+        {
+            Entity child;
+            Entity parent;
+        };
+
+        /*!
+            Links child to parent, moving the childs whole subtree to its new depth.
+            Returns false if the link would create a cycle.
+        */
+        bool SetParent( Entity child, Entity parent );
+
+        /*!
+            Removes the link to the entities parent, making it a root.
+            Its children are kept.
+        */
+        void ClearParent( Entity child );
+
+        /*!
+            Removes all links to and from the entity,
+            its children become roots. Called when an entity is destroyed.
+        */
+        void RemoveEntity( Entity id );
+
+        /*!
+            Returns the parent of the entity or INVALID_ENTITY if it is a root.
+        */
+        Entity GetParent( Entity id );
+
+        /*!
+            Returns the depth of the entity, 0 for roots.
+        */
+        int GetDepth( Entity id );
+
+        /*!
+            Returns the direct children of the entity.
+        */
+        const std::vector<Entity>& GetChildren( Entity id );
+
+        /*!
+            Returns the number of levels, the deepest entity has the depth GetLevelCount().
+        */
+        size_t GetLevelCount();
+
+        /*!
+            Returns the links of all entities at depth level+1.
+            The list is invalidated by any call modifying the hierarchy.
+        */
+        const std::vector<Link>& GetLevel( size_t level );
+
+    private:
+        struct Node
+        {
+            Entity parent;
+            int depth;
+            int slot;
+            std::vector<Entity> children;
+        };
+
+        Node& GetNode( Entity id );
+        void SetDepth( Entity id, int depth );
+        void DetachFromParent( Entity child );
+
+        std::vector<Node> m_nodes;
+        std::vector<std::vector<Link>> m_levels;
+        std::vector<Entity> m_noChildren;
+    };
+}
+
+#endif
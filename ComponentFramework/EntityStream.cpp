@@ -0,0 +1,283 @@
+#include "EntityStream.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace Core
+{
+    EntityBlockReader::EntityBlockReader( std::vector<unsigned char> block )
+    {
+        m_block.swap( block );
+        m_position = 0;
+        m_aspectOffset = 0;
+        m_valid = false;
+        memset( &m_header, 0, sizeof( m_header ) );
+
+        if( m_block.size() < sizeof( EntityBlockHeader ) )
+            return;
+
+        memcpy( &m_header, &m_block[0], sizeof( EntityBlockHeader ) );
+
+        if( m_header.magic != ENTITY_BLOCK_MAGIC || m_header.version != ENTITY_BLOCK_VERSION )
+            return;
+
+        //Aspects have one bit per component type
+        if( m_header.componentCount > sizeof( Aspect ) * 8 )
+            return;
+
+        //Sizes are checked by dividing the remaining bytes so corrupt counts can't wrap
+        size_t offset = sizeof( EntityBlockHeader );
+
+        if( ( m_block.size() - offset ) / sizeof( uint32_t ) < m_header.componentCount )
+            return;
+
+        for( size_t i = 0; i < m_header.componentCount; i++ )
+        {
+            uint32_t size;
+            memcpy( &size, &m_block[offset], sizeof( uint32_t ) );
+            m_typesizes.push_back( size );
+            offset += sizeof( uint32_t );
+        }
+
+        m_aspectOffset = offset;
+
+        if( ( m_block.size() - offset ) / sizeof( Aspect ) < m_header.entityCount )
+            return;
+
+        offset += m_header.entityCount * sizeof( Aspect );
+
+        Aspect known = m_header.componentCount == sizeof( Aspect ) * 8 ? ~0ULL : ( 1ULL << m_header.componentCount ) - 1;
+
+        //Each component section starts where the previous one ends
+        std::vector<size_t> counts( m_header.componentCount, 0 );
+        for( size_t e = 0; e < m_header.entityCount; e++ )
+        {
+            Aspect asp = GetAspect( e );
+
+            if( ( asp & ~known ) != 0ULL )
+                return;
+
+            for( size_t i = 0; i < m_header.componentCount; i++ )
+            {
+                if( (asp >> i) & 1ULL )
+                    counts[i]++;
+            }
+        }
+
+        for( size_t i = 0; i < m_header.componentCount; i++ )
+        {
+            if( counts[i] > 0 && ( m_block.size() - offset ) / counts[i] < m_typesizes[i] )
+                return;
+
+            m_cursors.push_back( offset );
+            offset += counts[i] * m_typesizes[i];
+        }
+
+        m_valid = m_block.size() == offset;
+    }
+
+    bool EntityBlockReader::IsCompatible( const size_t *typesizes, size_t componentCount )
+    {
+        if( m_valid == false || m_header.componentCount != componentCount )
+            return false;
+
+        for( size_t i = 0; i < componentCount; i++ )
+        {
+            if( m_typesizes[i] != typesizes[i] )
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t EntityBlockReader::GetEntityCount()
+    {
+        return m_valid ? m_header.entityCount : 0;
+    }
+
+    size_t EntityBlockReader::GetPosition()
+    {
+        return m_position;
+    }
+
+    bool EntityBlockReader::IsDone()
+    {
+        return m_position >= GetEntityCount();
+    }
+
+    Aspect EntityBlockReader::GetAspect( size_t index )
+    {
+        assert( index < m_header.entityCount );
+
+        Aspect asp;
+        memcpy( &asp, &m_block[m_aspectOffset + index * sizeof( Aspect )], sizeof( Aspect ) );
+        return asp;
+    }
+
+    const void* EntityBlockReader::NextComponent( ComponentType type )
+    {
+        assert( m_valid && type < m_cursors.size() );
+
+        const void *data = &m_block[m_cursors[type]];
+        m_cursors[type] += m_typesizes[type];
+
+        return data;
+    }
+
+    void EntityBlockReader::Advance( size_t count )
+    {
+        m_position += count;
+    }
+
+    EntityStreamer::EntityStreamer()
+    {
+        m_busy = 0;
+        m_quit = false;
+        m_thread = std::thread( &EntityStreamer::WorkerLoop, this );
+    }
+
+    EntityStreamer::~EntityStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_quit = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+    void EntityStreamer::Write( const std::string& path, std::vector<unsigned char> block )
+    {
+        Job job;
+        job.write = true;
+        job.ok = false;
+        job.path = path;
+        job.block.swap( block );
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_jobs.push_back( std::move( job ) );
+        }
+        m_wake.notify_one();
+    }
+
+    void EntityStreamer::Read( const std::string& path )
+    {
+        Job job;
+        job.write = false;
+        job.ok = false;
+        job.path = path;
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_jobs.push_back( std::move( job ) );
+        }
+        m_wake.notify_one();
+    }
+
+    bool EntityStreamer::PopLoaded( std::string& path, std::vector<unsigned char>& block, bool& ok )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        if( m_loaded.size() == 0 )
+            return false;
+
+        path.swap( m_loaded.front().path );
+        block.swap( m_loaded.front().block );
+        ok = m_loaded.front().ok;
+        m_loaded.pop_front();
+
+        return true;
+    }
+
+    bool EntityStreamer::PopWritten( std::string& path, bool& ok )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        if( m_written.size() == 0 )
+            return false;
+
+        path.swap( m_written.front().path );
+        ok = m_written.front().ok;
+        m_written.pop_front();
+
+        return true;
+    }
+
+    void EntityStreamer::Flush()
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_idle.wait( lock, [this]{ return m_jobs.size() == 0 && m_busy == 0; } );
+    }
+
+    void EntityStreamer::WorkerLoop()
+    {
+        for( ;; )
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock( m_mutex );
+                m_wake.wait( lock, [this]{ return m_quit || m_jobs.size() > 0; } );
+
+                if( m_jobs.size() == 0 )
+                    return;
+
+                job = std::move( m_jobs.front() );
+                m_jobs.pop_front();
+                m_busy++;
+            }
+
+            if( job.write )
+            {
+                FILE *file = fopen( job.path.c_str(), "wb" );
+                if( file != nullptr )
+                {
+                    job.ok = job.block.size() == 0 || fwrite( &job.block[0], job.block.size(), 1, file ) == 1;
+                    job.ok = fclose( file ) == 0 && job.ok;
+                }
+                else
+                {
+                    job.ok = false;
+                }
+            }
+            else
+            {
+                job.ok = false;
+
+                FILE *file = fopen( job.path.c_str(), "rb" );
+                if( file != nullptr )
+                {
+                    if( fseek( file, 0, SEEK_END ) == 0 )
+                    {
+                        long size = ftell( file );
+                        if( size >= 0 && fseek( file, 0, SEEK_SET ) == 0 )
+                        {
+                            job.block.resize( size );
+                            job.ok = size == 0 || fread( &job.block[0], size, 1, file ) == 1;
+                        }
+                    }
+                    fclose( file );
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+
+                if( job.write )
+                {
+                    job.block.clear();
+                    m_written.push_back( std::move( job ) );
+                }
+                else
+                {
+                    m_loaded.push_back( std::move( job ) );
+                }
+
+                m_busy--;
+            }
+            m_idle.notify_all();
+        }
+    }
+}
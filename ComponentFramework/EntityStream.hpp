@@ -0,0 +1,148 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_ENTITYSTREAM_H
+#define SRC_CORE_COMPONENTFRAMEWORK_ENTITYSTREAM_H
+
+#include "SystemTypes.hpp"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define ENTITY_BLOCK_MAGIC 0x4b525642
+#define ENTITY_BLOCK_VERSION 1
+
+namespace Core
+{
+    /*!
+        Layout of an entity block, as written by EntityHandler::SerializeEntities:
+            EntityBlockHeader
+            uint32_t typesize[componentCount]
+            Aspect aspect[entityCount]
+            for each component type, the packed data of every entity having it, in entity order.
+
+        Component data is stored as raw bytes, blocks are only meant to be read 
+        by the same build on the same platform that wrote them.
+    */
+    struct EntityBlockHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t componentCount;
+        uint32_t entityCount;
+    };
+
+    /*!
+        Reads an entity block front to back, used by EntityHandler::LoadEntities
+        to recreate the entities a few at a time.
+    */
+    class EntityBlockReader
+    {
+    public:
+        EntityBlockReader( std::vector<unsigned char> block );
+
+        /*!
+            Returns true if the block is well formed and was written with the given component sizes.
+        */
+        bool IsCompatible( const size_t *typesizes, size_t componentCount );
+
+        size_t GetEntityCount();
+
+        /*!
+            Returns the index of the next entity to be read.
+        */
+        size_t GetPosition();
+
+        bool IsDone();
+
+        /*!
+            Returns the aspect of the entity at index.
+        */
+        Aspect GetAspect( size_t index );
+
+        /*!
+            Returns the next unread data of a component type and moves past it.
+        */
+        const void* NextComponent( ComponentType type );
+
+        /*!
+            Moves the read position count entities forward.
+        */
+        void Advance( size_t count );
+
+    private:
+        std::vector<unsigned char> m_block;
+        EntityBlockHeader m_header;
+        bool m_valid;
+        size_t m_position;
+        size_t m_aspectOffset;
+        std::vector<size_t> m_typesizes;
+        std::vector<size_t> m_cursors;
+    };
+
+    /*!
+        EntityStreamer, background thread writing and reading entity blocks to and from disk,
+        so the simulation never waits on file access.
+    */
+    class EntityStreamer
+    {
+    public:
+        EntityStreamer();
+        ~EntityStreamer();
+
+        /*!
+            Queues a block to be written to path, the result is picked up with PopWritten.
+        */
+        void Write( const std::string& path, std::vector<unsigned char> block );
+
+        /*!
+            Queues path to be read, the result is picked up with PopLoaded.
+        */
+        void Read( const std::string& path );
+
+        /*!
+            Moves a finished read into block, returns false if there was none.
+            ok is false if the file couldn't be read.
+        */
+        bool PopLoaded( std::string& path, std::vector<unsigned char>& block, bool& ok );
+
+        /*!
+            Reports a finished write, returns false if there was none.
+            ok is false if the file couldn't be written completely.
+        */
+        bool PopWritten( std::string& path, bool& ok );
+
+        /*!
+            Blocks until all queued jobs are done.
+        */
+        void Flush();
+
+    private:
+        struct Job
+        {
+            bool write;
+            bool ok;
+            std::string path;
+            std::vector<unsigned char> block;
+        };
+
+        EntityStreamer( const EntityStreamer& );
+        EntityStreamer& operator=( const EntityStreamer& );
+
+        void WorkerLoop();
+
+        std::deque<Job> m_jobs;
+        std::deque<Job> m_loaded;
+        std::deque<Job> m_written;
+        size_t m_busy;
+        bool m_quit;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::thread m_thread;
+    };
+}
+
+#endif
@@ -6,9 +6,13 @@
 #include "SystemTypes.hpp"
 
 #include <cstdlib>
+#include <cstdio>
 #include <cassert>
 #include <cstring>
 #include <queue>
+#include <atomic>
+#include <vector>
+#include <algorithm>
 
 #define ONE_ENT_SIZE sizeof( Entity ) * COMPONENT_COUNT
 
@@ -17,6 +21,17 @@ namespace Core
     /*!
         EntityVector, internal datastructure used by the EntityHandler
         to store entities id'n and their component makeup.
+
+        Fresh idn are handed out from an atomic counter, so ranges of idn can be reserved 
+        from any thread with Reserve while the rest of the vector is used from the main thread.
+        Rows are only created for reserved idn once they are committed or returned.
+
+        Every row has a generation that is increased when its id is released, so handles to
+        a destroyed entity can be told from handles to the entity reusing its id.
+        Generations are never dropped, not even when Trim releases the rows.
+
+        The rows can be moved to memory owned by someone else with SetExternalRows,
+        the vector then has a fixed capacity and never reallocates.
     */
     template<size_t Initial, size_t Step, typename... Components>
     class EntityVector
@@ -26,19 +41,27 @@ namespace Core
         int *m_entities;
         size_t m_count;
         size_t m_size;
+        size_t m_rows;
+        std::atomic<size_t> m_next;
+        std::vector<uint32_t> m_generations;
+        bool m_external;
         static const int COMPONENT_COUNT = sizeof...(Components);
     public:
         EntityVector( )
         {
             m_count = 0;
             m_size = Initial;
+            m_rows = 0;
+            m_next = 0;
+            m_external = false;
 
             m_entities = (int*)malloc( m_size * ONE_ENT_SIZE );
         }
 
         ~EntityVector()
         {
-            free( m_entities );
+            if( m_external == false )
+                free( m_entities );
         }
 
         /*! 
@@ -48,13 +71,6 @@ namespace Core
         Entity Alloc()
         {
             Entity id = 0;
-            if( m_count >= m_size )
-            {
-                m_size += Step;
-                m_entities = (int*)realloc( m_entities, m_size * ONE_ENT_SIZE );
-                
-                assert( m_entities != nullptr );
-            }
 
             if( m_removed.size() > 0 )
             {
@@ -63,16 +79,84 @@ namespace Core
             }
             else
             {
-                id = m_count; 
+                id = (Entity)m_next.fetch_add( 1 ); 
+                EnsureRows( id + 1 );
             }
 
             m_count++;
+            m_generations[id]++;
 
             memset( &m_entities[id*COMPONENT_COUNT], 255, ONE_ENT_SIZE );
 
             return id;
         }
 
+        /*!
+            Allocates count entities at once, writing their ids to ids.
+            Previously destroyed idn are reused first, the rest is allocated
+            as a contiguous range with at most one reallocation.
+        */
+        void AllocBulk( size_t count, Entity *ids )
+        {
+            size_t reused = 0;
+
+            for( ; reused < count && m_removed.size() > 0; reused++ )
+            {
+                ids[reused] = m_removed.front();
+                m_removed.pop();
+                m_count++;
+                m_generations[ids[reused]]++;
+
+                memset( &m_entities[ids[reused]*COMPONENT_COUNT], 255, ONE_ENT_SIZE );
+            }
+
+            size_t fresh = count - reused;
+
+            if( fresh == 0 )
+                return;
+
+            size_t first = m_next.fetch_add( fresh );
+            EnsureRows( first + fresh );
+
+            for( size_t i = 0; i < fresh; i++ )
+            {
+                ids[reused+i] = (Entity)(first + i);
+                m_generations[first + i]++;
+            }
+
+            m_count += fresh;
+        }
+
+        /*!
+            Reserves count consecutive fresh idn and returns the first.
+            Lock-free and safe to call from any thread, also while the main thread allocates.
+            Every reserved id has to be passed to either CommitReserved or ReturnReserved
+            from the main thread before it can be used.
+        */
+        Entity Reserve( size_t count )
+        {
+            return (Entity)m_next.fetch_add( count );
+        }
+
+        /*!
+            Makes a reserved id a live entity without components.
+        */
+        void CommitReserved( Entity id )
+        {
+            EnsureRows( id + 1 );
+            m_generations[id]++;
+            m_count++;
+        }
+
+        /*!
+            Hands an unused reserved id to the free list.
+        */
+        void ReturnReserved( Entity id )
+        {
+            EnsureRows( id + 1 );
+            m_removed.push( id );
+        }
+
         /*!
             Releases the id of a given entity.
         */
@@ -82,10 +166,98 @@ namespace Core
             for( int i = 0; i < COMPONENT_COUNT; i++ )
                 m_entities[COMPONENT_COUNT*id+i] = -1; 
 
+            m_generations[id]++;
             m_removed.push( id );
             m_count--;
         }
 
+        /*!
+            The generation of a row is bumped when its id is handed out and when it is released,
+            so it is odd while the entity is alive and even while the id is free.
+        */
+        uint32_t GetGeneration( Entity id )
+        {
+            return m_generations[id];
+        }
+
+        /*!
+            Returns true if the id belongs to an entity that exists.
+        */
+        bool IsAlive( Entity id )
+        {
+            return id < m_generations.size() && ( m_generations[id] & 1 ) != 0;
+        }
+
+        /*!
+            Returns true if the id has been handed out and has generation, a single compare for live rows.
+        */
+        bool IsCurrent( Entity id, uint32_t generation )
+        {
+            return id < m_generations.size() && m_generations[id] == generation;
+        }
+
+        /*!
+            Drops released idn at the end of the id range and releases the memory of their rows,
+            the remaining released idn are reused lowest first. 
+            Does nothing while reserved idn are outstanding.
+        */
+        void Trim()
+        {
+            if( m_next != m_rows )
+                return;
+
+            std::vector<Entity> freeIds;
+            freeIds.reserve( m_removed.size() );
+
+            while( m_removed.size() > 0 )
+            {
+                freeIds.push_back( m_removed.front() );
+                m_removed.pop();
+            }
+            std::sort( freeIds.begin(), freeIds.end() );
+
+            while( freeIds.size() > 0 && freeIds.back() == m_rows - 1 )
+            {
+                freeIds.pop_back();
+                m_rows--;
+            }
+
+            for( size_t i = 0; i < freeIds.size(); i++ )
+                m_removed.push( freeIds[i] );
+
+            m_next = m_rows;
+
+            if( m_external == false && m_rows + Step < m_size )
+            {
+                m_size = m_rows + Step;
+                m_entities = (int*)realloc( m_entities, m_size * ONE_ENT_SIZE );
+
+                assert( m_entities != nullptr );
+            }
+        }
+
+        /*!
+            Moves the rows to a buffer of capacity rows owned by the caller.
+            Returns false if the capacity is too small. The buffer is not freed by the vector
+            and has to outlive it, allocating past the capacity aborts the process.
+        */
+        bool SetExternalRows( int *rows, size_t capacity )
+        {
+            if( capacity < m_rows || m_next != m_rows )
+                return false;
+
+            memcpy( rows, m_entities, m_rows * ONE_ENT_SIZE );
+
+            if( m_external == false )
+                free( m_entities );
+
+            m_entities = rows;
+            m_size = capacity;
+            m_external = true;
+
+            return true;
+        }
+
         template<typename Component>
         void SetComponentId( Entity id, int componentId )
         {
@@ -110,6 +282,14 @@ namespace Core
             return m_entities[COMPONENT_COUNT*id+componentType];
         }
 
+        /*!
+            Returns the address of an entities row of component idn, for prefetching.
+        */
+        const int* GetRow( Entity id )
+        {
+            return &m_entities[COMPONENT_COUNT*id];
+        }
+
         /*!
             Gets the currently active count of enities
         */
@@ -118,6 +298,15 @@ namespace Core
             return m_count;
         }
 
+        /*!
+            Gets the upper bound of all entity idn handed out so far,
+            every id below it is alive, released or reserved without components.
+        */
+        size_t GetIdRange()
+        {
+            return m_rows;
+        }
+
         /*!
             Gets the currently memory allocated slots for entties
         */
@@ -143,7 +332,8 @@ namespace Core
         }
 
         /*!
-            Calculates (in runtime) the given entities aspect and returns it
+            Calculates (in runtime) the given entities aspect and returns it,
+            cold components count as present.
         */
         Aspect GetAspect( Entity id )
         {
@@ -151,7 +341,7 @@ namespace Core
 
             for( int i = 0; i < COMPONENT_COUNT; i++ )
             {
-                if( m_entities[COMPONENT_COUNT*id+i] >= 0 )
+                if( m_entities[COMPONENT_COUNT*id+i] != -1 )
                 {
                     asp |=  1ULL << i;
                 }
@@ -159,6 +349,37 @@ namespace Core
 
             return asp;
         }
+
+    private:
+        /*!
+            Makes sure rows exist up to rows, new rows have no components.
+        */
+        void EnsureRows( size_t rows )
+        {
+            if( rows <= m_rows )
+                return;
+
+            if( rows > m_size )
+            {
+                //External rows have a fixed capacity, growing past it would write outside them
+                if( m_external )
+                {
+                    fprintf( stderr, "EntityVector: external rows for %zu entities are full\n", m_size );
+                    abort();
+                }
+
+                m_size = rows > m_size + Step ? rows : m_size + Step;
+                m_entities = (int*)realloc( m_entities, m_size * ONE_ENT_SIZE );
+
+                assert( m_entities != nullptr );
+            }
+
+            memset( &m_entities[m_rows*COMPONENT_COUNT], 255, ( rows - m_rows ) * ONE_ENT_SIZE );
+            m_rows = rows;
+
+            if( m_generations.size() < rows )
+                m_generations.resize( rows, 0 );
+        }
     };
 }
 
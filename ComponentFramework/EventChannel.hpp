@@ -0,0 +1,207 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_EVENTCHANNEL_H
+#define SRC_CORE_COMPONENTFRAMEWORK_EVENTCHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+
+namespace Core
+{
+    /*!
+        Type erased base of EventChannel so the SystemHandler can clear all channels.
+    */
+    class BaseEventChannel
+    {
+    public:
+        virtual ~BaseEventChannel() {}
+
+        /*!
+            Drops all unconsumed events, called by the SystemHandler at the end of every frame.
+        */
+        virtual void Clear() = 0;
+    };
+
+    /*!
+        Returns a process wide unique id per event type, used to index channels.
+    */
+    inline size_t NextEventTypeId()
+    {
+        static std::atomic<size_t> counter( 0 );
+        return counter++;
+    }
+
+    template<typename Event>
+    struct EventTypeId
+    {
+        static size_t Get()
+        {
+            static const size_t id = NextEventTypeId();
+            return id;
+        }
+    };
+
+    /*!
+        EventChannel, bounded lock-free multi producer single consumer ring buffer of events.
+
+        Any number of threads may Publish at the same time without locking, a single
+        consumer at a time may Drain or Consume. Events are meant to live for one frame, 
+        the SystemHandler clears every channel at the end of its Update, so consumers
+        should be listed after the producers they listen to.
+
+        Events should be plain data, they are copied in and out of the buffer.
+    */
+    template<typename Event>
+    class EventChannel : public BaseEventChannel
+    {
+    public:
+        /*!
+            Creates a channel holding at least capacity events, rounded up to a power of two.
+        */
+        EventChannel( size_t capacity )
+        {
+            size_t size = 2;
+            while( size < capacity )
+                size <<= 1;
+
+            m_mask = size - 1;
+            m_cells = new Cell[size];
+
+            for( size_t i = 0; i < size; i++ )
+                m_cells[i].sequence.store( i, std::memory_order_relaxed );
+
+            m_enqueuePos.store( 0, std::memory_order_relaxed );
+            m_dequeuePos = 0;
+            m_dropped.store( 0, std::memory_order_relaxed );
+        }
+
+        ~EventChannel()
+        {
+            delete [] m_cells;
+        }
+
+        /*!
+            Publishes an event, safe to call from any thread.
+            Returns false and counts the event as dropped if the channel is full.
+        */
+        bool Publish( const Event& ev )
+        {
+            size_t pos = m_enqueuePos.load( std::memory_order_relaxed );
+
+            for( ;; )
+            {
+                Cell& cell = m_cells[pos & m_mask];
+                size_t seq = cell.sequence.load( std::memory_order_acquire );
+                intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+                if( dif == 0 )
+                {
+                    if( m_enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                    {
+                        cell.data = ev;
+                        cell.sequence.store( pos + 1, std::memory_order_release );
+                        return true;
+                    }
+                }
+                else if( dif < 0 )
+                {
+                    m_dropped.fetch_add( 1, std::memory_order_relaxed );
+                    return false;
+                }
+                else
+                {
+                    pos = m_enqueuePos.load( std::memory_order_relaxed );
+                }
+            }
+        }
+
+        /*!
+            Moves up to max published events into out, returns how many were moved.
+            Consumer side only.
+        */
+        size_t Drain( Event* out, size_t max )
+        {
+            size_t count = 0;
+
+            while( count < max && Pop( out[count] ) )
+                count++;
+
+            return count;
+        }
+
+        /*!
+            Calls func( const Event& ) for every published event, returns how many were consumed.
+            Consumer side only.
+        */
+        template<typename Function>
+        size_t Consume( Function func )
+        {
+            size_t count = 0;
+            Event ev;
+
+            while( Pop( ev ) )
+            {
+                func( const_cast<const Event&>( ev ) );
+                count++;
+            }
+
+            return count;
+        }
+
+        virtual void Clear()
+        {
+            Event ev;
+            while( Pop( ev ) ) {}
+        }
+
+        /*!
+            Returns how many events were dropped because the channel was full.
+        */
+        size_t GetDropped()
+        {
+            return m_dropped.load( std::memory_order_relaxed );
+        }
+
+        size_t GetCapacity()
+        {
+            return m_mask + 1;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            Event data;
+        };
+
+        bool Pop( Event& out )
+        {
+            Cell& cell = m_cells[m_dequeuePos & m_mask];
+            size_t seq = cell.sequence.load( std::memory_order_acquire );
+
+            if( seq != m_dequeuePos + 1 )
+                return false;
+
+            out = cell.data;
+            cell.sequence.store( m_dequeuePos + m_mask + 1, std::memory_order_release );
+            m_dequeuePos++;
+
+            return true;
+        }
+
+        EventChannel( const EventChannel& );
+        EventChannel& operator=( const EventChannel& );
+
+        Cell *m_cells;
+        size_t m_mask;
+
+        //Producers and the consumer work on different ends, keep them on separate cache lines
+        char m_pad0[64];
+        std::atomic<size_t> m_enqueuePos;
+        char m_pad1[64];
+        size_t m_dequeuePos;
+        std::atomic<size_t> m_dropped;
+    };
+}
+
+#endif
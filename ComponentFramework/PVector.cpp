@@ -1,20 +1,36 @@
 #include "PVector.hpp"
 
 #include <iostream>
+#include <cstdio>
+#include <algorithm>
 
-Core::PVector::PVector( size_t initialSize, size_t growStep, size_t typesize )
+Core::PVector::PVector( size_t initialSize, size_t growStep, size_t typesize, bool doubleBuffered )
 {
     m_data = malloc( initialSize * typesize );
     m_size = initialSize;
     m_count = 0;
     m_growStep = growStep;
     m_typesize = typesize;
+    m_frame = 0;
+    m_external = false;
+
+    if( doubleBuffered )
+    {
+        m_previous = malloc( initialSize * typesize );
+        m_stamps = (unsigned int*)malloc( initialSize * sizeof( unsigned int ) );
+    }
 }
 
 
 Core::PVector::~PVector( )
 {
-    free( m_data );
+    if( m_external == false )
+    {
+        free( m_data );
+        free( m_previous );
+    }
+
+    free( m_stamps );
 }
 
 int Core::PVector::Alloc( void *def )
@@ -22,10 +38,7 @@ int Core::PVector::Alloc( void *def )
     int id = -1;
     if( m_count >= m_size )
     {
-        m_size += m_growStep;
-        m_data = realloc( m_data, m_size * m_typesize );
-
-        assert( m_data != NULL );
+        Resize( m_size + m_growStep );
     } 
 
     if( deleted.size() > 0 )
@@ -40,14 +53,181 @@ int Core::PVector::Alloc( void *def )
 
     m_count++;
 
+    if( m_stamps != nullptr )
+    {
+        m_stamps[id] = m_frame;
+    }
+
     if( def != nullptr )
     {
-        Set( id, def );
+        Init( id, def );
     }
 
     return id;
 }
 
+void Core::PVector::AllocBulk( size_t count, const void *def, int *ids )
+{
+    size_t reused = 0;
+
+    for( ; reused < count && deleted.size() > 0; reused++ )
+    {
+        ids[reused] = deleted.front();
+        deleted.pop();
+        m_count++;
+
+        if( m_stamps != nullptr )
+        {
+            m_stamps[ids[reused]] = m_frame;
+        }
+
+        if( def != nullptr )
+        {
+            Init( ids[reused], def );
+        }
+    }
+
+    size_t fresh = count - reused;
+
+    if( fresh == 0 )
+        return;
+
+    //The free list is empty so every slot below m_count is in use
+    if( m_count + fresh > m_size )
+    {
+        Resize( m_count + fresh > m_size + m_growStep ? m_count + fresh : m_size + m_growStep );
+    }
+
+    size_t first = m_count;
+    m_count += fresh;
+
+    for( size_t i = 0; i < fresh; i++ )
+    {
+        ids[reused+i] = (int)(first + i);
+    }
+
+    if( m_stamps != nullptr )
+    {
+        for( size_t i = 0; i < fresh; i++ )
+            m_stamps[first+i] = m_frame;
+    }
+
+    if( def != nullptr )
+    {
+        //Fill the range by doubling the copied block
+        unsigned char *base = &(((unsigned char*)m_data)[first*m_typesize]);
+        memcpy( base, def, m_typesize );
+
+        for( size_t copied = 1; copied < fresh; )
+        {
+            size_t chunk = copied < fresh - copied ? copied : fresh - copied;
+            memcpy( base + copied * m_typesize, base, chunk * m_typesize );
+            copied += chunk;
+        }
+
+        if( m_previous != nullptr )
+        {
+            memcpy( &(((unsigned char*)m_previous)[first*m_typesize]), base, fresh * m_typesize );
+        }
+    }
+}
+
+void Core::PVector::Resize( size_t size )
+{
+    //External buffers have a fixed capacity, shrinking keeps it. Growing past it
+    //would write outside the buffers, also in release builds
+    if( m_external )
+    {
+        if( size > m_size )
+        {
+            fprintf( stderr, "PVector: external buffers of %zu components are full\n", m_size );
+            abort();
+        }
+        return;
+    }
+
+    m_size = size;
+    m_data = realloc( m_data, m_size * m_typesize );
+
+    assert( m_data != NULL );
+
+    if( m_previous != nullptr )
+    {
+        m_previous = realloc( m_previous, m_size * m_typesize );
+        m_stamps = (unsigned int*)realloc( m_stamps, m_size * sizeof( unsigned int ) );
+
+        assert( m_previous != NULL && m_stamps != NULL );
+    }
+}
+
+bool Core::PVector::Compact( size_t maxMoves, std::vector<std::pair<int,int>>& moves )
+{
+    size_t highWater = GetHighWater();
+
+    std::vector<int> freeSlots;
+    freeSlots.reserve( deleted.size() );
+
+    while( deleted.size() > 0 )
+    {
+        freeSlots.push_back( deleted.front() );
+        deleted.pop();
+    }
+    std::sort( freeSlots.begin(), freeSlots.end() );
+
+    std::vector<bool> isFree( highWater, false );
+    for( size_t i = 0; i < freeSlots.size(); i++ )
+        isFree[freeSlots[i]] = true;
+
+    size_t hole = 0;
+    size_t top = highWater;
+
+    for( size_t moved = 0; ; moved++ )
+    {
+        while( top > 0 && isFree[top-1] )
+            top--;
+
+        if( hole >= freeSlots.size() || (size_t)freeSlots[hole] >= top || moved == maxMoves )
+            break;
+
+        int from = (int)top - 1;
+        int to = freeSlots[hole++];
+
+        Move( from, to );
+        isFree[from] = true;
+        isFree[to] = false;
+
+        moves.push_back( std::pair<int,int>( from, to ) );
+    }
+
+    while( top > 0 && isFree[top-1] )
+        top--;
+
+    //Slots from top and up are dropped, the rest stays free in ascending order
+    for( size_t i = hole; i < freeSlots.size() && (size_t)freeSlots[i] < top; i++ )
+        deleted.push( freeSlots[i] );
+
+    if( top + m_growStep < m_size )
+        Resize( top + m_growStep );
+
+    return deleted.size() == 0;
+}
+
+size_t Core::PVector::GetHighWater()
+{
+    return m_count + deleted.size();
+}
+
+void Core::PVector::Move( int from, int to )
+{
+    memcpy( &(((unsigned char*)m_data)[to*m_typesize]), &(((unsigned char*)m_data)[from*m_typesize]), m_typesize );
+
+    if( m_previous != nullptr )
+    {
+        memcpy( &(((unsigned char*)m_previous)[to*m_typesize]), &(((unsigned char*)m_previous)[from*m_typesize]), m_typesize );
+        m_stamps[to] = m_stamps[from];
+    }
+}
+
 void Core::PVector::Release( int id )
 {
     deleted.push( id );
@@ -58,12 +238,120 @@ void* Core::PVector::Get( int id )
 {
 
     assert( id >= 0 && id < (int)m_size );
-    return &(((unsigned char*)m_data)[id*m_typesize]);
+    void *slot = &(((unsigned char*)m_data)[id*m_typesize]);
+
+    if( m_stamps != nullptr && m_stamps[id] != m_frame )
+    {
+        m_stamps[id] = m_frame;
+    }
+
+    return slot;
+}
+
+const void* Core::PVector::GetPrevious( int id )
+{
+    if( m_previous == nullptr )
+        return GetAddress( id );
+
+    assert( id >= 0 && id < (int)m_size );
+    return &(((unsigned char*)m_previous)[id*m_typesize]);
+}
+
+void* Core::PVector::GetBuffer()
+{
+    if( m_stamps != nullptr )
+    {
+        size_t highWater = GetHighWater();
+
+        for( size_t id = 0; id < highWater; id++ )
+            m_stamps[id] = m_frame;
+    }
+
+    return m_data;
+}
+
+const void* Core::PVector::GetPreviousBuffer()
+{
+    return m_previous != nullptr ? m_previous : m_data;
 }
 
 void Core::PVector::Set( int id, const void *component )
 {
-    memcpy( Get(id), component, m_typesize );
+    assert( id >= 0 && id < (int)m_size );
+    memcpy( &(((unsigned char*)m_data)[id*m_typesize]), component, m_typesize );
+
+    if( m_stamps != nullptr )
+    {
+        m_stamps[id] = m_frame;
+    }
+}
+
+void Core::PVector::Init( int id, const void *component )
+{
+    Set( id, component );
+
+    if( m_previous != nullptr )
+    {
+        memcpy( &(((unsigned char*)m_previous)[id*m_typesize]), component, m_typesize );
+    }
+}
+
+void Core::PVector::Swap()
+{
+    if( m_previous == nullptr )
+        return;
+
+    //Publish this frames writes, every other slot is already equal in both buffers
+    size_t highWater = GetHighWater();
+
+    for( size_t id = 0; id < highWater; id++ )
+    {
+        if( m_stamps[id] == m_frame )
+            memcpy( &(((unsigned char*)m_previous)[id*m_typesize]), &(((unsigned char*)m_data)[id*m_typesize]), m_typesize );
+    }
+
+    m_frame++;
+}
+
+bool Core::PVector::SetExternalBuffers( void *current, void *previous, size_t capacity )
+{
+    assert( current != nullptr && ( m_previous == nullptr || previous != nullptr ) );
+
+    if( capacity < GetHighWater() )
+        return false;
+
+    memcpy( current, m_data, GetHighWater() * m_typesize );
+
+    if( m_previous != nullptr )
+    {
+        memcpy( previous, m_previous, GetHighWater() * m_typesize );
+        m_stamps = (unsigned int*)realloc( m_stamps, capacity * sizeof( unsigned int ) );
+
+        assert( m_stamps != NULL );
+    }
+
+    if( m_external == false )
+    {
+        free( m_data );
+        free( m_previous );
+    }
+
+    m_data = current;
+    m_previous = m_previous != nullptr ? previous : nullptr;
+    m_size = capacity;
+    m_external = true;
+
+    return true;
+}
+
+bool Core::PVector::IsDoubleBuffered()
+{
+    return m_previous != nullptr;
+}
+
+size_t Core::PVector::GetTypeSize()
+{
+    return m_typesize;
 }
 
 size_t Core::PVector::GetCount()
@@ -6,22 +6,41 @@
 #include <queue>
 #include <cassert>
 #include <cstring>
+#include <vector>
+#include <utility>
 
 namespace Core
 {
     /*!
         PVector the datastructure class used by EntityHandler to 
         store individual component types data in a consecutive list.
+
+        A double buffered PVector keeps a second, previous, buffer that is only
+        read during a frame. The write accessors, Get, Set, Init and GetBuffer, stamp a slot 
+        with the current frame and Swap copies the slots stamped this frame to the previous buffer.
+        Both buffers therefore hold the latest value of every slot after a Swap, also for
+        slots left alone for several frames, and the buffers themselves never move.
+        Reading through GetAddress doesn't stamp, so read-only access costs nothing at Swap.
+
+        The buffers can be moved to memory owned by someone else, like a shared memory region,
+        with SetExternalBuffers. The vector then has a fixed capacity and never reallocates.
     */
     class PVector
     {
     private:
         void *m_data = nullptr;
+        void *m_previous = nullptr;
+        unsigned int *m_stamps = nullptr;
+        unsigned int m_frame;
+        bool m_external;
         size_t m_size;
         size_t m_count;
         size_t m_growStep;
         size_t m_typesize;
         std::queue<int> deleted;
+
+        void Resize( size_t size );
+        void Move( int from, int to );
     public:
 
 
@@ -30,8 +49,9 @@ namespace Core
             of initialSize * sizeof(Component).
             
             /param growStep size step growth for each time the array isn't large enough.
+            /param doubleBuffered keep a previous buffer, see Swap.
         */
-        PVector( size_t initialSize, size_t growStep, size_t typesize );
+        PVector( size_t initialSize, size_t growStep, size_t typesize, bool doubleBuffered = false );
 
         ~PVector( );
 
@@ -48,6 +68,17 @@ namespace Core
         */
         int Alloc(void *def);
 
+        /*!
+            Allocates count components at once, writing their ids to ids.
+            Holes are reused first, the rest is taken as one contiguous range 
+            with a single reallocation and filled from def with block copies.
+            def may be nullptr to leave the data uninitialized.
+
+            Whenever this function is called, all pointers
+            to data in this structure are invalidated.
+        */
+        void AllocBulk( size_t count, const void *def, int *ids );
+
         /*!
             Releses a component from the array, making it available 
             for reallocation.
@@ -60,10 +91,85 @@ namespace Core
             return (T*)Get(id);
         }
 
+        /*!
+            Returns the slot in the current buffer for writing.
+            For double buffered vectors the slot is stamped so the next Swap publishes it,
+            use GetAddress to only read it.
+        */
         void* Get( int id );
 
+        /*!
+            Returns the slot in the previous buffer, which is safe to read
+            while other threads write the current buffer. 
+            Same as Get for vectors that aren't double buffered.
+        */
+        const void* GetPrevious( int id );
+
+        /*!
+            Returns the address of a slot in the current buffer without marking it written,
+            for reading it and for prefetching ahead of a Get.
+        */
+        const void* GetAddress( int id )
+        {
+            return &(((unsigned char*)m_data)[id*m_typesize]);
+        }
+
+        /*!
+            Returns the whole current buffer, for bulk access. For double buffered vectors
+            every used slot is stamped as written so the next Swap publishes changes made through it.
+        */
+        void* GetBuffer();
+
+        /*!
+            Returns the whole previous buffer, the same as GetBuffer for vectors that aren't double buffered.
+        */
+        const void* GetPreviousBuffer();
+
         void Set( int id, const void* component );
 
+        /*!
+            Sets a newly created component, for double buffered vectors
+            both buffers are set so readers see the initial value right away.
+        */
+        void Init( int id, const void* component );
+
+        /*!
+            Copies the slots written this frame to the previous buffer, called once at the frame boundary.
+            Does nothing for vectors that aren't double buffered.
+        */
+        void Swap();
+
+        bool IsDoubleBuffered();
+
+        /*!
+            Moves the data to buffers of capacity components owned by the caller, previous is
+            only used for double buffered vectors. Returns false if the capacity is too small.
+            The buffers are not freed by the vector and have to outlive it,
+            allocating past the capacity aborts the process.
+        */
+        bool SetExternalBuffers( void *current, void *previous, size_t capacity );
+
+        /*!
+            Moves up to maxMoves of the highest used slots into the lowest free ones,
+            appending each ( from, to ) pair to moves so the owner can update its ids.
+            The free list is rebuilt in ascending order and memory above the highest
+            used slot is released. Returns true when no free slot is left below the highest used one.
+
+            Whenever this function is called, all pointers
+            to data in this structure are invalidated.
+        */
+        bool Compact( size_t maxMoves, std::vector<std::pair<int,int>>& moves );
+
+        /*!
+            Returns the number of slots handed out, used or free.
+        */
+        size_t GetHighWater();
+
+        /*!
+            Returns the size in bytes of a single component.
+        */
+        size_t GetTypeSize();
+
         /*!
             Returns how many active components there are.
         */
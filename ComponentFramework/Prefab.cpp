@@ -0,0 +1,54 @@
+#include "Prefab.hpp"
+
+#include <cassert>
+#include <cstring>
+
+namespace Core
+{
+    Prefab::Prefab()
+    {
+        m_aspect = 0ULL;
+
+        for( int i = 0; i < MAX_COMPONENTS; i++ )
+            m_offsets[i] = -1;
+    }
+
+    Aspect Prefab::GetAspect() const
+    {
+        return m_aspect;
+    }
+
+    const void* Prefab::GetComponentData( ComponentType type ) const
+    {
+        assert( type < MAX_COMPONENTS );
+
+        if( m_offsets[type] < 0 )
+            return nullptr;
+
+        return &m_data[m_offsets[type]];
+    }
+
+    void* Prefab::GetComponentData( ComponentType type )
+    {
+        assert( type < MAX_COMPONENTS );
+
+        if( m_offsets[type] < 0 )
+            return nullptr;
+
+        return &m_data[m_offsets[type]];
+    }
+
+    void Prefab::SetComponentData( ComponentType type, const void *data, size_t size )
+    {
+        assert( type < MAX_COMPONENTS );
+
+        if( m_offsets[type] < 0 )
+        {
+            m_offsets[type] = (int)m_data.size();
+            m_data.resize( m_data.size() + size );
+            m_aspect |= 1ULL << type;
+        }
+
+        memcpy( &m_data[m_offsets[type]], data, size );
+    }
+}
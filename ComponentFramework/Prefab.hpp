@@ -0,0 +1,45 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_PREFAB_H
+#define SRC_CORE_COMPONENTFRAMEWORK_PREFAB_H
+
+#include "SystemTypes.hpp"
+
+#include <vector>
+
+namespace Core
+{
+    /*!
+        Prefab, a set of components with their default values, captured once
+        and instantiated any number of times through EntityHandler::InstantiatePrefab.
+        Created by the EntityHandler, which knows the component type ids.
+    */
+    class Prefab
+    {
+    public:
+        Prefab();
+
+        /*!
+            Returns the aspect of the entities instantiated from this prefab.
+        */
+        Aspect GetAspect() const;
+
+        /*!
+            Returns the default value of a component in the prefab, or nullptr if it isn't part of it.
+        */
+        const void* GetComponentData( ComponentType type ) const;
+        void* GetComponentData( ComponentType type );
+
+        /*!
+            Adds a component to the prefab or replaces its default value.
+        */
+        void SetComponentData( ComponentType type, const void *data, size_t size );
+
+    private:
+        static const int MAX_COMPONENTS = 64;
+
+        Aspect m_aspect;
+        int m_offsets[MAX_COMPONENTS];
+        std::vector<unsigned char> m_data;
+    };
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_PREFETCH_H
+#define SRC_CORE_COMPONENTFRAMEWORK_PREFETCH_H
+
+/*!
+    Hints the cpu to start loading the cache line at addr for reading.
+    Never faults, so it may be given addresses that end up unused.
+*/
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define CORE_PREFETCH( addr ) __builtin_prefetch( (const void*)(addr) )
+#elif defined( _MSC_VER )
+#include <xmmintrin.h>
+#define CORE_PREFETCH( addr ) _mm_prefetch( (const char*)(addr), _MM_HINT_T0 )
+#else
+#define CORE_PREFETCH( addr ) ((void)(addr))
+#endif
+
+#endif
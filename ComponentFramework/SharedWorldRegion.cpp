@@ -0,0 +1,282 @@
+#include "SharedWorldRegion.hpp"
+
+#include <cstring>
+#include <cassert>
+#include <thread>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SHARED_WORLD_ALIGN( x ) ( ( (x) + 63 ) & ~(uint64_t)63 )
+
+namespace Core
+{
+    /*!
+        Returns true if count elements of size bytes starting at offset lie within regionSize bytes,
+        dividing rather than multiplying so values read from another process can't wrap.
+    */
+    static bool InRegion( uint64_t offset, uint64_t count, uint64_t size, uint64_t regionSize )
+    {
+        if( offset > regionSize )
+            return false;
+
+        return size == 0 || count <= ( regionSize - offset ) / size;
+    }
+
+    SharedWorldRegion::SharedWorldRegion()
+    {
+        m_data = nullptr;
+        m_size = 0;
+        m_fd = -1;
+        m_writer = false;
+        m_name[0] = 0;
+    }
+
+    SharedWorldRegion::~SharedWorldRegion()
+    {
+        Close();
+    }
+
+    bool SharedWorldRegion::Create( const char *name, const SharedComponentDesc *components, size_t componentCount,
+        size_t entityCapacity, size_t rowSize, const char * const *systems, size_t systemCount )
+    {
+        Close();
+
+#if defined(__unix__) || defined(__APPLE__)
+        if( strlen( name ) >= sizeof( m_name ) )
+            return false;
+
+        uint64_t offset = SHARED_WORLD_ALIGN( sizeof( SharedWorldHeader )
+            + componentCount * sizeof( SharedComponentInfo ) + systemCount * sizeof( SharedSystemInfo ) );
+
+        uint64_t entityOffset = offset;
+        offset = SHARED_WORLD_ALIGN( offset + entityCapacity * rowSize );
+
+        uint64_t componentsOffset = offset;
+        for( size_t i = 0; i < componentCount; i++ )
+        {
+            size_t buffers = components[i].doubleBuffered ? 2 : 1;
+            offset = SHARED_WORLD_ALIGN( offset + buffers * components[i].capacity * components[i].typesize );
+        }
+
+        shm_unlink( name );
+        m_fd = shm_open( name, O_CREAT | O_EXCL | O_RDWR, 0600 );
+
+        if( m_fd < 0 )
+            return false;
+
+        strcpy( m_name, name );
+        m_writer = true;
+
+        if( ftruncate( m_fd, (off_t)offset ) != 0 || Map( (size_t)offset, true ) == false )
+        {
+            Close();
+            return false;
+        }
+
+        //Fresh shared memory is zeroed, only the non zero fields are written
+        SharedWorldHeader *header = new( m_data ) SharedWorldHeader;
+        header->magic = SHARED_WORLD_MAGIC;
+        header->version = SHARED_WORLD_VERSION;
+        header->componentCount = (uint32_t)componentCount;
+        header->systemCount = (uint32_t)systemCount;
+        header->totalSize = offset;
+        header->sequence = 0;
+        header->entityRowSize = (uint32_t)rowSize;
+        header->frame = 0;
+        header->entityOffset = entityOffset;
+        header->entityCapacity = entityCapacity;
+
+        memset( GetData( entityOffset ), 255, entityCapacity * rowSize );
+
+        offset = componentsOffset;
+        for( size_t i = 0; i < componentCount; i++ )
+        {
+            SharedComponentInfo *info = GetComponent( i );
+            strncpy( info->name, components[i].name, SHARED_WORLD_NAME_LENGTH - 1 );
+            info->typesize = (uint32_t)components[i].typesize;
+            info->doubleBuffered = components[i].doubleBuffered ? 1 : 0;
+            info->capacity = components[i].capacity;
+            info->currentOffset = offset;
+            info->previousOffset = offset;
+
+            size_t bufferSize = components[i].capacity * components[i].typesize;
+
+            if( components[i].doubleBuffered )
+                info->previousOffset = offset + bufferSize;
+
+            offset = SHARED_WORLD_ALIGN( offset + ( info->doubleBuffered + 1 ) * bufferSize );
+        }
+
+        for( size_t i = 0; i < systemCount; i++ )
+        {
+            SharedSystemInfo *info = GetSystem( i );
+            strncpy( info->name, systems[i], SHARED_WORLD_NAME_LENGTH - 1 );
+            info->cycles = info->instructions = info->cacheMisses = info->branchMisses = -1;
+        }
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool SharedWorldRegion::Open( const char *name )
+    {
+        Close();
+
+#if defined(__unix__) || defined(__APPLE__)
+        m_fd = shm_open( name, O_RDONLY, 0 );
+
+        if( m_fd < 0 )
+            return false;
+
+        struct stat st;
+        if( fstat( m_fd, &st ) != 0 || (size_t)st.st_size < sizeof( SharedWorldHeader ) || Map( (size_t)st.st_size, false ) == false )
+        {
+            Close();
+            return false;
+        }
+
+        SharedWorldHeader *header = GetHeader();
+
+        if( header->magic != SHARED_WORLD_MAGIC || header->version != SHARED_WORLD_VERSION || header->totalSize > m_size )
+        {
+            Close();
+            return false;
+        }
+
+        //The counts are 32 bit, so the table sizes can't wrap
+        uint64_t tables = sizeof( SharedWorldHeader ) + (uint64_t)header->componentCount * sizeof( SharedComponentInfo )
+            + (uint64_t)header->systemCount * sizeof( SharedSystemInfo );
+
+        bool valid = tables <= m_size && InRegion( header->entityOffset, header->entityCapacity, header->entityRowSize, m_size );
+
+        for( size_t i = 0; valid && i < header->componentCount; i++ )
+        {
+            SharedComponentInfo *info = GetComponent( i );
+
+            valid = InRegion( info->currentOffset, info->capacity, info->typesize, m_size )
+                && InRegion( info->previousOffset, info->capacity, info->typesize, m_size );
+        }
+
+        if( valid == false )
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void SharedWorldRegion::Close()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if( m_data != nullptr )
+            munmap( m_data, m_size );
+
+        if( m_fd >= 0 )
+            close( m_fd );
+
+        if( m_writer )
+            shm_unlink( m_name );
+#endif
+
+        m_data = nullptr;
+        m_size = 0;
+        m_fd = -1;
+        m_writer = false;
+        m_name[0] = 0;
+    }
+
+    bool SharedWorldRegion::IsOpen()
+    {
+        return m_data != nullptr;
+    }
+
+    bool SharedWorldRegion::IsWriter()
+    {
+        return m_writer;
+    }
+
+    SharedWorldHeader* SharedWorldRegion::GetHeader()
+    {
+        return (SharedWorldHeader*)m_data;
+    }
+
+    SharedComponentInfo* SharedWorldRegion::GetComponent( size_t index )
+    {
+        assert( index < GetHeader()->componentCount );
+        return &((SharedComponentInfo*)( m_data + sizeof( SharedWorldHeader ) ))[index];
+    }
+
+    SharedSystemInfo* SharedWorldRegion::GetSystem( size_t index )
+    {
+        assert( index < GetHeader()->systemCount );
+        SharedComponentInfo *end = (SharedComponentInfo*)( m_data + sizeof( SharedWorldHeader ) ) + GetHeader()->componentCount;
+        return &((SharedSystemInfo*)end)[index];
+    }
+
+    void* SharedWorldRegion::GetData( uint64_t offset )
+    {
+        assert( offset <= m_size );
+        return m_data + offset;
+    }
+
+    void SharedWorldRegion::BeginWrite()
+    {
+        assert( m_writer );
+
+        std::atomic<uint32_t>& sequence = GetHeader()->sequence;
+        sequence.store( sequence.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_release );
+    }
+
+    void SharedWorldRegion::EndWrite()
+    {
+        std::atomic<uint32_t>& sequence = GetHeader()->sequence;
+        sequence.store( sequence.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    }
+
+    uint32_t SharedWorldRegion::BeginRead()
+    {
+        uint32_t sequence;
+
+        while( ( sequence = GetHeader()->sequence.load( std::memory_order_acquire ) ) & 1 )
+            std::this_thread::yield();
+
+        return sequence;
+    }
+
+    bool SharedWorldRegion::EndRead( uint32_t sequence )
+    {
+        std::atomic_thread_fence( std::memory_order_acquire );
+        return GetHeader()->sequence.load( std::memory_order_relaxed ) == sequence;
+    }
+
+    bool SharedWorldRegion::Map( size_t size, bool writable )
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        void *data = mmap( nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0 );
+
+        if( data == MAP_FAILED )
+            return false;
+
+        m_data = (unsigned char*)data;
+        m_size = size;
+        return true;
+#else
+        return false;
+#endif
+    }
+}
+
+#undef SHARED_WORLD_ALIGN
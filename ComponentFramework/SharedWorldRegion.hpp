@@ -0,0 +1,160 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_SHAREDWORLDREGION_H
+#define SRC_CORE_COMPONENTFRAMEWORK_SHAREDWORLDREGION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+namespace Core
+{
+    static const uint32_t SHARED_WORLD_MAGIC = 0x4b525357;
+    static const uint32_t SHARED_WORLD_VERSION = 2;
+    static const size_t SHARED_WORLD_NAME_LENGTH = 32;
+
+    /*!
+        Start of a shared world region. All offsets are in bytes from the start of the region,
+        the component table follows the header and the system table follows the component table.
+    */
+    struct SharedWorldHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t componentCount;
+        uint32_t systemCount;
+        uint64_t totalSize;
+
+        //Odd while the simulation publishes a frame
+        std::atomic<uint32_t> sequence;
+        uint32_t entityRowSize;
+        uint64_t frame;
+
+        //Entity table, one row of entityRowSize bytes of component idn per entity, 
+        //-1 for no component and -2 for frozen ones
+        uint64_t entityOffset;
+        uint64_t entityCapacity;
+        uint64_t entityRows;
+        uint64_t entityCount;
+    };
+
+    struct SharedComponentInfo
+    {
+        char name[SHARED_WORLD_NAME_LENGTH];
+        uint32_t typesize;
+        uint32_t doubleBuffered;
+        uint64_t capacity;
+        uint64_t currentOffset;
+        //Same as currentOffset for components that aren't double buffered
+        uint64_t previousOffset;
+        uint64_t count;
+        uint64_t highWater;
+    };
+
+    struct SharedSystemInfo
+    {
+        char name[SHARED_WORLD_NAME_LENGTH];
+        int64_t frameTimeUs;
+        int64_t cycles;
+        int64_t instructions;
+        int64_t cacheMisses;
+        int64_t branchMisses;
+    };
+
+    /*!
+        Describes the storage of one component type when creating a region.
+    */
+    struct SharedComponentDesc
+    {
+        const char *name;
+        size_t typesize;
+        bool doubleBuffered;
+        size_t capacity;
+    };
+
+    /*!
+        SharedWorldRegion, a POSIX shared memory object holding the component buffers,
+        the entity table and per system frame stats of a world, so a tool in another local process
+        can read them without the simulation serializing anything.
+
+        The simulation creates the region and moves its storage into it, see
+        EntityHandlerTemplate::ShareStorage and SharedWorldViewTemplate. Tools Open it read-only.
+
+        Consistency uses a sequence counter, the simulation brackets publishing a frame with
+        BeginWrite and EndWrite and never waits for readers. A reader copies what it needs between
+        BeginRead and EndRead and retries when EndRead returns false. Everything written inside the
+        write bracket is consistent: the frame number, counts, system stats and the previous buffers
+        of double buffered components. The current buffers and the entity table are written live
+        by the simulation and may be read mid change.
+
+        Only implemented on unix-like systems, elsewhere Create and Open return false.
+    */
+    class SharedWorldRegion
+    {
+    public:
+        SharedWorldRegion();
+        ~SharedWorldRegion();
+
+        SharedWorldRegion( const SharedWorldRegion& ) = delete;
+        SharedWorldRegion& operator=( const SharedWorldRegion& ) = delete;
+
+        /*!
+            Creates the shared memory object name, replacing an existing one, and lays it out.
+            The object is unlinked again when the region is closed.
+            \param name object name starting with a slash, like "/kravall-world"
+            \param entityCapacity max number of entity rows
+            \param rowSize size of one entity row in bytes
+        */
+        bool Create( const char *name, const SharedComponentDesc *components, size_t componentCount,
+            size_t entityCapacity, size_t rowSize, const char * const *systems, size_t systemCount );
+
+        /*!
+            Maps an existing region read-only, fails if the header doesn't describe a valid region
+            or if any table, the entity table or a component buffer doesn't lie within the object.
+        */
+        bool Open( const char *name );
+
+        void Close();
+
+        bool IsOpen();
+
+        /*!
+            Returns true if this process created the region and may write to it.
+        */
+        bool IsWriter();
+
+        SharedWorldHeader* GetHeader();
+        SharedComponentInfo* GetComponent( size_t index );
+        SharedSystemInfo* GetSystem( size_t index );
+
+        /*!
+            Returns the address of an offset in the region.
+        */
+        void* GetData( uint64_t offset );
+
+        /*!
+            Starts publishing, readers started before EndWrite will retry.
+        */
+        void BeginWrite();
+        void EndWrite();
+
+        /*!
+            Waits for a running publish to finish and returns the sequence to pass to EndRead.
+        */
+        uint32_t BeginRead();
+
+        /*!
+            Returns true if nothing was published since BeginRead returned sequence.
+        */
+        bool EndRead( uint32_t sequence );
+
+    private:
+        bool Map( size_t size, bool writable );
+
+        unsigned char *m_data;
+        size_t m_size;
+        int m_fd;
+        bool m_writer;
+        char m_name[256];
+    };
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_SHAREDWORLDVIEW_H
+#define SRC_CORE_COMPONENTFRAMEWORK_SHAREDWORLDVIEW_H
+
+#include "SharedWorldRegion.hpp"
+
+#include <PerfCounters.hpp>
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <cassert>
+
+namespace Core
+{
+    /*!
+        SharedWorldView, publishes a world to a SharedWorldRegion for out of process tools.
+        Create moves the EntityHandlers storage into the region, after that PublishFrame is
+        called once per frame after the SystemHandler update in place of SwapComponentBuffers.
+
+        A tool opens the region by name with SharedWorldRegion::Open and reads the previous buffers of
+        double buffered components and the system stats inside a BeginRead/EndRead pair.
+        Only those, the frame number and the counts are changed inside the publish bracket and read
+        as one frame. The entity table and the buffers of components that aren't double buffered
+        are written live during the frame, a tool reading them may see them mid change
+        and out of step with the previous buffers, even when EndRead succeeds.
+    */
+    template<typename EntityHandlerT>
+    class SharedWorldViewTemplate
+    {
+    public:
+        typedef typename EntityHandlerT::SystemHandler SystemHandlerT;
+
+        SharedWorldViewTemplate( EntityHandlerT *entityHandler, SystemHandlerT *systemHandler )
+        {
+            m_entityHandler = entityHandler;
+            m_systemHandler = systemHandler;
+        }
+
+        /*!
+            Creates the region and shares the storage with it, see EntityHandlerTemplate::ShareStorage.
+            \param componentCapacity max number of components of each type
+            \param entityCapacity max number of entity idn
+        */
+        bool Create( const char *name, size_t componentCapacity, size_t entityCapacity )
+        {
+            std::array<SharedComponentDesc,EntityHandlerT::COMPONENT_COUNT> layout = m_entityHandler->GetSharedLayout( componentCapacity );
+            std::vector<std::pair<const char*,std::chrono::microseconds>> frameTimes = m_systemHandler->GetFrameTime();
+
+            std::vector<const char*> systems;
+            for( size_t i = 0; i < frameTimes.size(); i++ )
+                systems.push_back( frameTimes[i].first );
+
+            if( m_region.Create( name, &layout[0], layout.size(), entityCapacity, EntityHandlerT::GetSharedRowSize(),
+                    systems.size() > 0 ? &systems[0] : nullptr, systems.size() ) == false )
+                return false;
+
+            if( m_entityHandler->ShareStorage( m_region ) == false )
+            {
+                m_region.Close();
+                return false;
+            }
+
+            return true;
+        }
+
+        /*!
+            Swaps the component buffers and publishes the counts and the last updates system stats.
+            The frame number, counts, system stats and previous buffers of double buffered components
+            are only changed between BeginWrite and EndWrite, so readers get them as one consistent frame.
+            The entity table and the current buffers are not copied, see the class description.
+            Call at the frame boundary when no system is running.
+        */
+        void PublishFrame()
+        {
+            assert( m_region.IsOpen() );
+
+            m_region.BeginWrite();
+
+            m_entityHandler->SwapComponentBuffers();
+            m_entityHandler->PublishSharedStats( m_region );
+
+            std::vector<std::pair<const char*,std::chrono::microseconds>> frameTimes = m_systemHandler->GetFrameTime();
+            std::vector<std::pair<const char*,PerfCounterValues>> counters = m_systemHandler->GetFrameCounters();
+
+            for( size_t i = 0; i < frameTimes.size(); i++ )
+            {
+                SharedSystemInfo *info = m_region.GetSystem( i );
+                info->frameTimeUs = frameTimes[i].second.count();
+                info->cycles = counters[i].second.cycles;
+                info->instructions = counters[i].second.instructions;
+                info->cacheMisses = counters[i].second.cacheMisses;
+                info->branchMisses = counters[i].second.branchMisses;
+            }
+
+            m_region.GetHeader()->frame++;
+
+            m_region.EndWrite();
+        }
+
+        SharedWorldRegion& GetRegion()
+        {
+            return m_region;
+        }
+
+    private:
+        EntityHandlerT *m_entityHandler;
+        SystemHandlerT *m_systemHandler;
+
+        SharedWorldRegion m_region;
+    };
+}
+
+#endif
@@ -0,0 +1,379 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_SPATIALGRIDSYSTEM_H
+#define SRC_CORE_COMPONENTFRAMEWORK_SPATIALGRIDSYSTEM_H
+
+#include "BaseSystem.hpp"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace Core
+{
+    /*!
+        A single query for the batched SpatialGridSystem queries.
+        For nearest queries, radius is the max search distance, 0 or less means unbounded.
+    */
+    struct SpatialQuery
+    {
+        float x;
+        float y;
+        float radius;
+    };
+
+    /*!
+        Range of results belonging to one query in a batched radius query.
+    */
+    struct SpatialQueryRange
+    {
+        size_t begin;
+        size_t count;
+    };
+
+    /*!
+        SpatialGridSystem, reusable uniform grid over entity positions for neighbour queries.
+
+        PositionPolicy decides which entities are indexed and where they are:
+            static Aspect GetAspect();
+            void GetPosition( Entity id, float& x, float& y );
+
+        The policy is typically implemented in a source file where the EntityHandler is known,
+        which avoids the circular dependency between the handlers and the system. GetPosition
+        should find the EntityHandler through WorldTemplate::GetCurrent(), so the same system type
+        works in every world, or through state set on the policy with GetPositionPolicy.
+
+        Entities are inserted and removed as they enter and leave the aspect, Update re-reads the
+        positions and only moves entities that changed cell. Each cell stores its entities together
+        with their position so queries don't need to touch component data.
+
+        Positions outside the grid are clamped into the border cells, queries stay exact but slower there.
+        All queries are const and may be called from any number of threads,
+        as long as no structural change or Update of this system runs at the same time.
+    */
+    template<typename PositionPolicy>
+    class SpatialGridSystem : public BaseSystem
+    {
+    public:
+        SpatialGridSystem() : BaseSystem( PositionPolicy::GetAspect(), 0ULL )
+        {
+            SetGrid( -512.0f, -512.0f, 8.0f, 128, 128 );
+        }
+
+        /*!
+            Sets the grid dimensions, rebuilding the grid if there are entities in it.
+        */
+        void SetGrid( float minX, float minY, float cellSize, int width, int height )
+        {
+            assert( cellSize > 0.0f && width > 0 && height > 0 );
+
+            m_minX = minX;
+            m_minY = minY;
+            m_cellSize = cellSize;
+            m_invCellSize = 1.0f / cellSize;
+            m_width = width;
+            m_height = height;
+
+            m_cells.clear();
+            m_cells.resize( width * height );
+
+            for( size_t i = 0; i < m_records.size(); i++ )
+                m_records[i].cell = -1;
+
+            for( size_t i = 0; i < m_entities.size(); i++ )
+                Insert( m_entities[i] );
+        }
+
+        virtual void Update( float )
+        {
+            for( size_t i = 0; i < m_entities.size(); i++ )
+            {
+                Entity id = m_entities[i];
+                Record& rec = m_records[id];
+
+                float x, y;
+                m_policy.GetPosition( id, x, y );
+
+                int cell = GetCell( x, y );
+
+                if( cell == rec.cell )
+                {
+                    Entry& entry = m_cells[cell][rec.slot];
+                    entry.x = x;
+                    entry.y = y;
+                }
+                else
+                {
+                    Remove( id );
+                    Insert( id, x, y, cell );
+                }
+            }
+        }
+
+        virtual void ChangedEntity( Entity id, Aspect old_asp, Aspect new_asp )
+        {
+            BaseSystem::ChangedEntity( id, old_asp, new_asp );
+
+            bool wasIndexed = AspectMatch( old_asp ) && old_asp != 0ULL;
+            bool isIndexed = AspectMatch( new_asp ) && new_asp != 0ULL;
+
+            if( wasIndexed && isIndexed == false )
+                Remove( id );
+            else if( wasIndexed == false && isIndexed )
+                Insert( id );
+        }
+
+        virtual const char * GetHumanName() { return "SpatialGridSystem"; }
+
+        /*!
+            Returns the policy instance used to read positions, for policies that keep state.
+        */
+        PositionPolicy& GetPositionPolicy() { return m_policy; }
+
+        /*!
+            Appends all entities within radius of (x,y) to out.
+        */
+        void QueryRadius( float x, float y, float radius, std::vector<Entity>& out ) const
+        {
+            int minCX, minCY, maxCX, maxCY;
+            GetCellCoord( x - radius, y - radius, minCX, minCY );
+            GetCellCoord( x + radius, y + radius, maxCX, maxCY );
+
+            float radiusSq = radius * radius;
+
+            for( int cy = minCY; cy <= maxCY; cy++ )
+            {
+                for( int cx = minCX; cx <= maxCX; cx++ )
+                {
+                    const std::vector<Entry>& cell = m_cells[cy * m_width + cx];
+
+                    for( size_t i = 0; i < cell.size(); i++ )
+                    {
+                        float dx = cell[i].x - x;
+                        float dy = cell[i].y - y;
+
+                        if( dx * dx + dy * dy <= radiusSq )
+                            out.push_back( cell[i].entity );
+                    }
+                }
+            }
+        }
+
+        /*!
+            Batched radius query. Queries are processed in cell order so neighbouring
+            queries reuse the same cells while they are hot in cache.
+            The results of queries[i] are found at ranges[i] in results.
+        */
+        void QueryRadius( const SpatialQuery* queries, size_t count, std::vector<Entity>& results, std::vector<SpatialQueryRange>& ranges ) const
+        {
+            std::vector<std::pair<int,size_t>> order;
+            SortQueries( queries, count, order );
+
+            ranges.resize( count );
+
+            for( size_t i = 0; i < count; i++ )
+            {
+                const SpatialQuery& query = queries[order[i].second];
+                SpatialQueryRange& range = ranges[order[i].second];
+
+                range.begin = results.size();
+                QueryRadius( query.x, query.y, query.radius, results );
+                range.count = results.size() - range.begin;
+            }
+        }
+
+        /*!
+            Finds the up to k closest entities to (x,y) within maxRadius, 0 or less for unbounded.
+            The result is written sorted by distance to out, which must hold k entities.
+            Returns the number of entities found.
+        */
+        size_t QueryNearest( float x, float y, size_t k, float maxRadius, Entity* out ) const
+        {
+            std::vector<std::pair<float,Entity>> heap;
+            return QueryNearest( x, y, k, maxRadius, out, heap );
+        }
+
+        /*!
+            Batched nearest query, results for queries[i] are written to results[i*k] and
+            padded with INVALID_ENTITY when fewer than k entities were found.
+        */
+        void QueryNearest( const SpatialQuery* queries, size_t count, size_t k, Entity* results ) const
+        {
+            std::vector<std::pair<int,size_t>> order;
+            SortQueries( queries, count, order );
+
+            std::vector<std::pair<float,Entity>> heap;
+            heap.reserve( k );
+
+            for( size_t i = 0; i < count; i++ )
+            {
+                const SpatialQuery& query = queries[order[i].second];
+                Entity* out = &results[order[i].second * k];
+
+                size_t found = QueryNearest( query.x, query.y, k, query.radius, out, heap );
+
+                for( size_t f = found; f < k; f++ )
+                    out[f] = INVALID_ENTITY;
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            float x;
+            float y;
+            Entity entity;
+        };
+
+        struct Record
+        {
+            int cell;
+            int slot;
+        };
+
+        void GetCellCoord( float x, float y, int& cx, int& cy ) const
+        {
+            float fx = std::min( std::max( (x - m_minX) * m_invCellSize, 0.0f ), (float)(m_width - 1) );
+            float fy = std::min( std::max( (y - m_minY) * m_invCellSize, 0.0f ), (float)(m_height - 1) );
+
+            cx = (int)fx;
+            cy = (int)fy;
+        }
+
+        int GetCell( float x, float y ) const
+        {
+            int cx, cy;
+            GetCellCoord( x, y, cx, cy );
+            return cy * m_width + cx;
+        }
+
+        void Insert( Entity id )
+        {
+            float x, y;
+            m_policy.GetPosition( id, x, y );
+            Insert( id, x, y, GetCell( x, y ) );
+        }
+
+        void Insert( Entity id, float x, float y, int cell )
+        {
+            if( id >= m_records.size() )
+            {
+                Record empty = { -1, -1 };
+                m_records.resize( id + 1, empty );
+            }
+
+            Entry entry = { x, y, id };
+
+            m_records[id].cell = cell;
+            m_records[id].slot = (int)m_cells[cell].size();
+            m_cells[cell].push_back( entry );
+        }
+
+        void Remove( Entity id )
+        {
+            Record& rec = m_records[id];
+            assert( rec.cell >= 0 );
+
+            std::vector<Entry>& cell = m_cells[rec.cell];
+
+            cell[rec.slot] = cell.back();
+            m_records[cell[rec.slot].entity].slot = rec.slot;
+            cell.pop_back();
+
+            rec.cell = -1;
+            rec.slot = -1;
+        }
+
+        void SortQueries( const SpatialQuery* queries, size_t count, std::vector<std::pair<int,size_t>>& order ) const
+        {
+            order.resize( count );
+
+            for( size_t i = 0; i < count; i++ )
+                order[i] = std::pair<int,size_t>( GetCell( queries[i].x, queries[i].y ), i );
+
+            std::sort( order.begin(), order.end() );
+        }
+
+        size_t QueryNearest( float x, float y, size_t k, float maxRadius, Entity* out, std::vector<std::pair<float,Entity>>& heap ) const
+        {
+            heap.clear();
+
+            if( k == 0 )
+                return 0;
+
+            float maxSq = maxRadius > 0.0f ? maxRadius * maxRadius : std::numeric_limits<float>::max();
+
+            int cx, cy;
+            GetCellCoord( x, y, cx, cy );
+
+            int rings = std::max( m_width, m_height );
+
+            for( int r = 0; r < rings; r++ )
+            {
+                //Every entity in ring r is at least (r-1) cells away
+                float bound = (r - 1) * m_cellSize;
+                if( r > 0 && bound * bound > maxSq )
+                    break;
+                if( r > 0 && heap.size() == k && bound * bound > heap.front().first )
+                    break;
+
+                for( int y0 = cy - r; y0 <= cy + r; y0++ )
+                {
+                    if( y0 < 0 || y0 >= m_height )
+                        continue;
+
+                    //Only the border of the ring is new
+                    int step = ( y0 == cy - r || y0 == cy + r ) ? 1 : std::max( 2 * r, 1 );
+
+                    for( int x0 = cx - r; x0 <= cx + r; x0 += step )
+                    {
+                        if( x0 < 0 || x0 >= m_width )
+                            continue;
+
+                        const std::vector<Entry>& cell = m_cells[y0 * m_width + x0];
+
+                        for( size_t i = 0; i < cell.size(); i++ )
+                        {
+                            float dx = cell[i].x - x;
+                            float dy = cell[i].y - y;
+                            float distSq = dx * dx + dy * dy;
+
+                            if( distSq > maxSq )
+                                continue;
+
+                            if( heap.size() < k )
+                            {
+                                heap.push_back( std::pair<float,Entity>( distSq, cell[i].entity ) );
+                                std::push_heap( heap.begin(), heap.end() );
+                            }
+                            else if( distSq < heap.front().first )
+                            {
+                                std::pop_heap( heap.begin(), heap.end() );
+                                heap.back() = std::pair<float,Entity>( distSq, cell[i].entity );
+                                std::push_heap( heap.begin(), heap.end() );
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::sort_heap( heap.begin(), heap.end() );
+
+            for( size_t i = 0; i < heap.size(); i++ )
+                out[i] = heap[i].second;
+
+            return heap.size();
+        }
+
+        PositionPolicy m_policy;
+
+        float m_minX, m_minY;
+        float m_cellSize, m_invCellSize;
+        int m_width, m_height;
+
+        std::vector<std::vector<Entry>> m_cells;
+        std::vector<Record> m_records;
+    };
+}
+
+#endif
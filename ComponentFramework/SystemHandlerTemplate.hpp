@@ -3,13 +3,21 @@
 
 #include "BaseSystem.hpp"
 #include "PVector.hpp"
+#include "EventChannel.hpp"
+#include "EntityBagRegistry.hpp"
 #include <TemplateUtility/TemplateIndex.hpp>
+#include <TemplateUtility/IndexSequence.hpp>
 
 #include <array>
+#include <tuple>
 #include <utility>
 #include <vector>
+#include <cmath>
+#include <cassert>
+#include <type_traits>
 
 #include <Timer.hpp>
+#include <PerfCounters.hpp>
 
 
 #define GNAME( name ) #name
@@ -17,10 +25,23 @@
 
 namespace Core
 {
+    /*!
+        True if System has its own ChangedEntity, in which case it has to be 
+        called per entity rather than through the batched BaseSystem::ChangedEntities.
+    */
+    template<typename System>
+    struct OverridesChangedEntity
+    {
+        static const bool value = !std::is_same<decltype(&System::ChangedEntity), void (BaseSystem::*)( Entity, Aspect, Aspect )>::value;
+    };
+
     /*!
         SystemHandler, stores systems, calls them and handles callbacks from EntityHandler to Systems.
         Can be created and called every frame to apply the registered systems transformation on 
         registered entities
+
+        Systems are stored by value and every call to them is expanded per system type at compile-time, 
+        so Update and ChangedEntity are called directly rather than through the vtable.
     */
     template<typename... Args>
     class SystemHandlerTemplate
@@ -33,11 +54,28 @@ namespace Core
         */
         SystemHandlerTemplate( )
         {
-            m_systems = {{(new Args())...}};
+            m_systemPointers = {{ static_cast<BaseSystem*>( &std::get<Index<Args, std::tuple<Args...>>::value>( m_systems ) )... }};
+            m_frame = 0;
+            m_perfEnabled = false;
+
+            for( int i = 0; i < SYSTEM_COUNT; i++ )
+            {
+                m_accumulated[i] = 0.0f;
+                m_frameTimes[i] = std::chrono::microseconds( 0 );
+                m_budgets[i] = std::chrono::microseconds( 0 );
+                m_frameCounters[i] = NoCounters();
+            }
+
+            for( int i = 0; i < SYSTEM_COUNT; i++ )
+                m_systemPointers[i]->BindSharedBags( m_sharedBags );
+
+            ResolvePhases();
         }
 
         ~SystemHandlerTemplate()
         {
+            for( size_t i = 0; i < m_channels.size(); i++ )
+                delete m_channels[i];
         } 
 
         /*!
@@ -50,21 +88,69 @@ namespace Core
 
         /*!
             Main update loop, called every frame to update all systems
+            according to their UpdatePolicy.
         */
         void Update( float delta )
         {
-            for( int i = 0; i < SYSTEM_COUNT; i++ )
+            UpdateAll( delta, typename MakeIndexSequence<SYSTEM_COUNT>::type() );
+
+            for( size_t i = 0; i < m_channels.size(); i++ )
             {
-				m_timer.Start();
-                 
-                m_systems[i]->Update( delta );
+                if( m_channels[i] != nullptr )
+                    m_channels[i]->Clear();
+            }
+
+            m_frame++;
+        }
 
-				m_timer.Stop();
+        /*!
+            Creates the channel for an event type, call during setup 
+            before any system publishes or consumes the event.
+        */
+        template <typename Event>
+        EventChannel<Event>* RegisterEventChannel( size_t capacity )
+        {
+            size_t id = EventTypeId<Event>::Get();
+
+            if( id >= m_channels.size() )
+                m_channels.resize( id + 1, nullptr );
+
+            assert( m_channels[id] == nullptr );
+            m_channels[id] = new EventChannel<Event>( capacity );
+
+            return static_cast<EventChannel<Event>*>( m_channels[id] );
+        }
+
+        /*!
+            Returns the channel for an event type, safe to call from parallel systems.
+        */
+        template <typename Event>
+        EventChannel<Event>* GetEventChannel()
+        {
+            size_t id = EventTypeId<Event>::Get();
 
-				std::chrono::microseconds diff = m_timer.GetDelta();
+            assert( id < m_channels.size() && m_channels[id] != nullptr );
+            return static_cast<EventChannel<Event>*>( m_channels[id] );
+        }
 
-                m_frameTimes[i] = diff; 
-            } 
+        /*!
+            Changes the UpdatePolicy of a system and recalculates the staggered phases.
+        */
+        template <typename System>
+        void SetUpdatePolicy( const UpdatePolicy& policy )
+        {
+            GetSystem<System>()->SetUpdatePolicy( policy );
+            ResolvePhases();
+        }
+
+        /*!
+            Gives a system a time budget per update, passed to its UpdateSliced.
+            A budget of zero, the default, means the system is updated without limit.
+        */
+        template <typename System>
+        void SetFrameBudget( std::chrono::microseconds budget )
+        {
+            m_budgets[Index<System, std::tuple<Args...>>::value] = budget;
         }
     
         /*!
@@ -72,26 +158,41 @@ namespace Core
         */
         void CallChangedEntity( Entity id, Aspect old_asp, Aspect new_asp )
         {
-            for( int i = 0; i < SYSTEM_COUNT; i++ )
-            {
-                m_systems[i]->ChangedEntity( id, old_asp, new_asp );
-            }
+            m_sharedBags.ChangedEntity( id, old_asp, new_asp );
+            ChangedEntityAll( id, old_asp, new_asp, typename MakeIndexSequence<SYSTEM_COUNT>::type() );
         };
 
+        /*!
+            Intended to be called by EntityHandler when many entities go through the same change at once.
+        */
+        void CallChangedEntities( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp )
+        {
+            m_sharedBags.ChangedEntities( ids, count, old_asp, new_asp );
+            ChangedEntitiesAll( ids, count, old_asp, new_asp, typename MakeIndexSequence<SYSTEM_COUNT>::type() );
+        }
+
+        /*!
+            Returns the number of distinct shared bags requested by the systems.
+        */
+        size_t GetSharedBagCount()
+        {
+            return m_sharedBags.GetBagCount();
+        }
+
         /*!
             This function primarily exist for testing purposes,
             don't use it without thinking about it first.
         */
         BaseSystem *GetSystem( int id )
         {
-            return m_systems[id];
+            return m_systemPointers[id];
         }
 
 
         template <typename System>
         System* GetSystem()
         {
-            return reinterpret_cast<System*>(m_systems[Index<System, std::tuple<Args...>>::value]);
+            return &std::get<Index<System, std::tuple<Args...>>::value>( m_systems );
         }
 
         std::vector<std::pair<const char*,std::chrono::microseconds>> GetFrameTime()
@@ -100,16 +201,238 @@ namespace Core
 
             for( int i = 0; i < SYSTEM_COUNT; i++ )
             {
-                ar.push_back( std::pair<const char*, std::chrono::microseconds>( m_systems[i]->GetHumanName(), m_frameTimes[i] ) );
+                ar.push_back( std::pair<const char*, std::chrono::microseconds>( m_systemPointers[i]->GetHumanName(), m_frameTimes[i] ) );
+            }
+
+            return ar;
+        }
+
+        /*!
+            Turns on reading hardware counters around each system in Update,
+            must be enabled from the thread calling Update.
+            Returns false if no counters are available, in which case
+            GetFrameCounters keeps reporting -1 and Update runs as before.
+        */
+        bool EnablePerfCounters( bool enable )
+        {
+            if( enable )
+                m_perfEnabled = m_perf.Open();
+            else
+            {
+                m_perf.Close();
+                m_perfEnabled = false;
+            }
+
+            for( int i = 0; i < SYSTEM_COUNT; i++ )
+                m_frameCounters[i] = NoCounters();
+
+            return m_perfEnabled;
+        }
+
+        /*!
+            Returns the hardware counters of each system from the last Update,
+            in the same order as GetFrameTime.
+        */
+        std::vector<std::pair<const char*,PerfCounterValues>> GetFrameCounters()
+        {
+            std::vector<std::pair<const char*,PerfCounterValues>> ar;
+
+            for( int i = 0; i < SYSTEM_COUNT; i++ )
+            {
+                ar.push_back( std::pair<const char*, PerfCounterValues>( m_systemPointers[i]->GetHumanName(), m_frameCounters[i] ) );
             }
 
             return ar;
         }
 
     private:
-        std::array<BaseSystem*,SYSTEM_COUNT> m_systems;
+        static PerfCounterValues NoCounters()
+        {
+            PerfCounterValues values = { -1, -1, -1, -1 };
+            return values;
+        }
+
+        template <std::size_t I>
+        struct SystemAt
+        {
+            typedef typename std::tuple_element<I, std::tuple<Args...>>::type type;
+        };
+
+        template <std::size_t... I>
+        void UpdateAll( float delta, IndexSequence<I...> )
+        {
+            int expand[] = { 0, (UpdateSystem<I>( delta ), 0)... };
+            (void)expand;
+        }
+
+        template <std::size_t I>
+        void UpdateSystem( float delta )
+        {
+            typename SystemAt<I>::type& system = std::get<I>( m_systems );
+            const UpdatePolicy& policy = system.GetUpdatePolicy();
+
+            if( m_perfEnabled )
+                m_perf.Start();
+
+            m_timer.Start();
+
+            switch( policy.type )
+            {
+            case UpdatePolicy::FIXED_STEP:
+                {
+                    m_accumulated[I] += delta;
+
+                    int steps = 0;
+                    while( m_accumulated[I] >= policy.step && steps < policy.maxSteps )
+                    {
+                        RunSystem<I>( policy.step );
+                        m_accumulated[I] -= policy.step;
+                        steps++;
+                    }
+
+                    //Drop what couldn't be caught up with
+                    if( m_accumulated[I] >= policy.step )
+                        m_accumulated[I] = std::fmod( m_accumulated[I], policy.step );
+                }
+                break;
+
+            case UpdatePolicy::EVERY_NTH_FRAME:
+                m_accumulated[I] += delta;
+
+                if( m_frame % policy.interval == (unsigned int)m_phases[I] )
+                {
+                    RunSystem<I>( m_accumulated[I] );
+                    m_accumulated[I] = 0.0f;
+                }
+                break;
+
+            default:
+                RunSystem<I>( delta );
+                break;
+            }
+
+            m_timer.Stop();
+
+            if( m_perfEnabled )
+            {
+                m_perf.Stop();
+                m_frameCounters[I] = m_perf.GetDelta();
+            }
+
+            m_frameTimes[I] = m_timer.GetDelta();
+        }
+
+        template <std::size_t I>
+        void RunSystem( float delta )
+        {
+            typedef typename SystemAt<I>::type System;
+            System& system = std::get<I>( m_systems );
+
+            //Qualified calls, bound at compile-time
+            if( m_budgets[I].count() > 0 )
+                system.System::UpdateSliced( delta, m_budgets[I] );
+            else
+                system.System::Update( delta );
+
+            system.ClearBagChanges();
+        }
+
+        template <std::size_t... I>
+        void ChangedEntityAll( Entity id, Aspect old_asp, Aspect new_asp, IndexSequence<I...> )
+        {
+            int expand[] = { 0, (ChangedEntityT<I>( id, old_asp, new_asp, std::integral_constant<bool, OverridesChangedEntity<typename SystemAt<I>::type>::value>() ), 0)... };
+            (void)expand;
+        }
+
+        template <std::size_t I>
+        void ChangedEntityT( Entity id, Aspect old_asp, Aspect new_asp, std::true_type )
+        {
+            typedef typename SystemAt<I>::type System;
+            std::get<I>( m_systems ).System::ChangedEntity( id, old_asp, new_asp );
+        }
+
+        template <std::size_t I>
+        void ChangedEntityT( Entity id, Aspect old_asp, Aspect new_asp, std::false_type )
+        {
+            BaseSystem& system = std::get<I>( m_systems );
+
+            if( system.IsAffected( old_asp, new_asp ) )
+                system.BaseSystem::ChangedEntity( id, old_asp, new_asp );
+        }
+
+        template <std::size_t... I>
+        void ChangedEntitiesAll( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp, IndexSequence<I...> )
+        {
+            int expand[] = { 0, (ChangedEntitiesT<I>( ids, count, old_asp, new_asp, std::integral_constant<bool, OverridesChangedEntity<typename SystemAt<I>::type>::value>() ), 0)... };
+            (void)expand;
+        }
+
+        template <std::size_t I>
+        void ChangedEntitiesT( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp, std::true_type )
+        {
+            typedef typename SystemAt<I>::type System;
+            System& system = std::get<I>( m_systems );
+
+            for( size_t j = 0; j < count; j++ )
+                system.System::ChangedEntity( ids[j], old_asp, new_asp );
+        }
+
+        template <std::size_t I>
+        void ChangedEntitiesT( const Entity *ids, size_t count, Aspect old_asp, Aspect new_asp, std::false_type )
+        {
+            BaseSystem& system = std::get<I>( m_systems );
+
+            if( system.IsAffected( old_asp, new_asp ) )
+                system.ChangedEntities( ids, count, old_asp, new_asp );
+        }
+
+        /*!
+            Spreads systems running every nth frame with AUTO_PHASE over the 
+            frames in their interval, in the order they were listed.
+        */
+        void ResolvePhases()
+        {
+            for( int i = 0; i < SYSTEM_COUNT; i++ )
+            {
+                const UpdatePolicy& policy = m_systemPointers[i]->GetUpdatePolicy();
+
+                m_phases[i] = 0;
+
+                if( policy.type != UpdatePolicy::EVERY_NTH_FRAME )
+                    continue;
+
+                if( policy.phase != AUTO_PHASE )
+                {
+                    m_phases[i] = policy.phase % policy.interval;
+                    continue;
+                }
+
+                int earlier = 0;
+                for( int j = 0; j < i; j++ )
+                {
+                    const UpdatePolicy& other = m_systemPointers[j]->GetUpdatePolicy();
+
+                    if( other.type == UpdatePolicy::EVERY_NTH_FRAME && other.phase == AUTO_PHASE && other.interval == policy.interval )
+                        earlier++;
+                }
+
+                m_phases[i] = earlier % policy.interval;
+            }
+        }
+
+        std::tuple<Args...> m_systems;
+        std::array<BaseSystem*,SYSTEM_COUNT> m_systemPointers;
         std::array<std::chrono::microseconds,SYSTEM_COUNT> m_frameTimes;
+        std::array<std::chrono::microseconds,SYSTEM_COUNT> m_budgets;
+        std::array<float,SYSTEM_COUNT> m_accumulated;
+        std::array<int,SYSTEM_COUNT> m_phases;
+        unsigned int m_frame;
+        std::vector<BaseEventChannel*> m_channels;
+        EntityBagRegistry m_sharedBags;
 		HighresTimer m_timer;
+        std::array<PerfCounterValues,SYSTEM_COUNT> m_frameCounters;
+        PerfCounters m_perf;
+        bool m_perfEnabled;
     };
 }
 #endif
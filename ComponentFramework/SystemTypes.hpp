@@ -13,6 +13,23 @@ namespace Core
     typedef uint64_t Aspect;
     typedef size_t ComponentType;
     typedef int ComponentId;
+
+    /*!
+        Entity id together with the generation of its row when the handle was made.
+        Ids are reused after an entity is destroyed, the generation tells the entities apart,
+        see EntityHandler::GetHandle and IsValid.
+    */
+    struct EntityHandle
+    {
+        Entity id;
+        uint32_t generation;
+
+        bool operator==( const EntityHandle& other ) const { return id == other.id && generation == other.generation; }
+        bool operator!=( const EntityHandle& other ) const { return !( *this == other ); }
+    };
+
+    //Component id of the components of a frozen entity, see EntityHandler::Freeze
+    static const ComponentId COLD_COMPONENT = -2;
 }
 
 #endif
@@ -0,0 +1,59 @@
+#include "TimeSlicedSystem.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+Core::TimeSlicedSystem::TimeSlicedSystem( Aspect inclusive, Aspect exclusive, size_t batchSize )
+    : BaseSystem( std::vector<EntityBag>( 1, EntityBag( inclusive, exclusive ) ) )
+{
+    assert( batchSize > 0 );
+    m_batchSize = batchSize;
+    m_inPass = false;
+}
+
+void Core::TimeSlicedSystem::Update( float delta )
+{
+    RunSlices( delta, std::chrono::microseconds( 0 ), false );
+}
+
+void Core::TimeSlicedSystem::UpdateSliced( float delta, std::chrono::microseconds budget )
+{
+    RunSlices( delta, budget, true );
+}
+
+void Core::TimeSlicedSystem::RunSlices( float delta, std::chrono::microseconds budget, bool limited )
+{
+    m_timer.Start();
+
+    EntityBag& bag = m_bags[0];
+
+    if( m_inPass == false )
+    {
+        bag.SetCursor( 0 );
+        BeginPass();
+        m_inPass = true;
+    }
+
+    for( ;; )
+    {
+        size_t cursor = bag.GetCursor();
+
+        if( cursor >= bag.m_entities.size() )
+        {
+            EndPass();
+            m_inPass = false;
+            bag.SetCursor( 0 );
+            break;
+        }
+
+        size_t count = std::min( m_batchSize, bag.m_entities.size() - cursor );
+
+        //Move the cursor first so entities removed by the batch keep it correct
+        bag.SetCursor( cursor + count );
+        UpdateBatch( &bag.m_entities[cursor], count, delta );
+
+        m_timer.Stop();
+        if( limited && m_timer.GetDelta() >= budget )
+            break;
+    }
+}
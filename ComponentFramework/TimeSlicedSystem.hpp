@@ -0,0 +1,61 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_TIMESLICEDSYSTEM_H
+#define SRC_CORE_COMPONENTFRAMEWORK_TIMESLICEDSYSTEM_H
+
+#include "BaseSystem.hpp"
+
+#include <Timer.hpp>
+
+namespace Core
+{
+    /*!
+        TimeSlicedSystem, base for systems whose work over all their entities
+        doesn't fit in one frame. The entities are visited in batches from a cursor 
+        kept in the systems bag, when given a budget by the SystemHandler the system 
+        stops once it is spent and continues from the cursor next frame.
+
+        Entities that join the bag during a pass are visited in the same pass,
+        entities that leave it are never visited after leaving.
+    */
+    class TimeSlicedSystem : public BaseSystem
+    {
+    public:
+        TimeSlicedSystem( Aspect inclusive, Aspect exclusive, size_t batchSize = 64 );
+
+        /*!
+            Finishes the current pass without any time limit.
+        */
+        virtual void Update( float delta );
+
+        /*!
+            Processes batches until the budget is spent or the pass is finished.
+            At least one batch is processed per call so the pass always advances.
+        */
+        virtual void UpdateSliced( float delta, std::chrono::microseconds budget );
+
+    protected:
+        /*!
+            Called before the first batch of a pass.
+        */
+        virtual void BeginPass() {}
+
+        /*!
+            Called with each batch of entities, delta is the delta of the current frame.
+            Structural changes made from here invalidate the entities pointer.
+        */
+        virtual void UpdateBatch( const Entity* entities, size_t count, float delta ) = 0;
+
+        /*!
+            Called after the last batch of a pass.
+        */
+        virtual void EndPass() {}
+
+    private:
+        void RunSlices( float delta, std::chrono::microseconds budget, bool limited );
+
+        size_t m_batchSize;
+        bool m_inPass;
+        HighresTimer m_timer;
+    };
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_UPDATEPOLICY_H
+#define SRC_CORE_COMPONENTFRAMEWORK_UPDATEPOLICY_H
+
+#define AUTO_PHASE -1
+
+namespace Core
+{
+    /*!
+        UpdatePolicy, decides how often the SystemHandler calls a systems Update
+        and with what delta.
+
+        EVERY_FRAME         Update is called once every frame with the frame delta (default).
+        FIXED_STEP          Update is called zero or more times with step as delta, driven by
+                            an accumulator. At most maxSteps are run in one frame, any time 
+                            beyond that is dropped so a slow frame can't spiral.
+        EVERY_NTH_FRAME     Update is called every interval frames with the time accumulated 
+                            since the last call. Systems with AUTO_PHASE and the same interval 
+                            are spread over different frames by the SystemHandler.
+    */
+    struct UpdatePolicy
+    {
+        enum Type
+        {
+            EVERY_FRAME,
+            FIXED_STEP,
+            EVERY_NTH_FRAME
+        };
+
+        Type type;
+        float step;
+        int maxSteps;
+        int interval;
+        int phase;
+
+        static UpdatePolicy EveryFrame()
+        {
+            UpdatePolicy policy = { EVERY_FRAME, 0.0f, 1, 1, 0 };
+            return policy;
+        }
+
+        static UpdatePolicy FixedStep( float step, int maxSteps = 4 )
+        {
+            UpdatePolicy policy = { FIXED_STEP, step, maxSteps, 1, 0 };
+            return policy;
+        }
+
+        static UpdatePolicy EveryNthFrame( int interval, int phase = AUTO_PHASE )
+        {
+            UpdatePolicy policy = { EVERY_NTH_FRAME, 0.0f, 1, interval, phase };
+            return policy;
+        }
+    };
+}
+
+#endif
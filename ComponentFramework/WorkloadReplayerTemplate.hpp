@@ -0,0 +1,136 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_WORKLOADREPLAYER_H
+#define SRC_CORE_COMPONENTFRAMEWORK_WORKLOADREPLAYER_H
+
+#include "WorkloadTrace.hpp"
+
+#include <vector>
+#include <cassert>
+
+namespace Core
+{
+    /*!
+        WorkloadReplayer, re-drives an EntityHandler from a recorded trace, one frame at a time.
+        Recorded entity ids are mapped to the ids the handler hands out, so the replay
+        doesn't depend on the handler giving out the same ids as the recording.
+
+        Created components get their default values, as component data isn't part of the trace.
+        Typical headless use is replaying a frame, updating the SystemHandler with the returned delta
+        and timing both.
+    */
+    template<typename EntityHandlerT>
+    class WorkloadReplayerTemplate
+    {
+    public:
+        WorkloadReplayerTemplate( EntityHandlerT *entityHandler, WorkloadReader *reader )
+        {
+            m_entityHandler = entityHandler;
+            m_reader = reader;
+            m_opCount = 0;
+
+            assert( m_reader->IsCompatible( EntityHandlerT::COMPONENT_COUNT ) );
+        }
+
+        /*!
+            Applies operations up to and including the next frame marker and writes its delta.
+            Returns false when the trace is done, operations after the last marker are still applied.
+        */
+        bool ReplayFrame( float& delta )
+        {
+            WorkloadOp op;
+
+            while( m_reader->Next( op ) )
+            {
+                m_opCount++;
+
+                switch( op.type )
+                {
+                case WORKLOAD_FRAME:
+                    delta = op.delta;
+                    return true;
+
+                case WORKLOAD_CREATE:
+                    {
+                        Entity id = m_entityHandler->CreateEntity();
+
+                        if( op.aspect != 0ULL )
+                            m_entityHandler->AddComponentsAspect( id, op.aspect );
+
+                        Map( op.entity, id );
+                    }
+                    break;
+
+                case WORKLOAD_CREATE_BULK:
+                    {
+                        const std::vector<Entity>& recorded = m_reader->GetBulkIds();
+                        m_bulk.resize( op.count );
+
+                        if( op.count > 0 )
+                            m_entityHandler->InstantiatePrefab( m_entityHandler->CreatePrefabFromAspect( op.aspect ), op.count, &m_bulk[0] );
+
+                        for( size_t i = 0; i < op.count; i++ )
+                            Map( recorded[i], m_bulk[i] );
+                    }
+                    break;
+
+                case WORKLOAD_ADD:
+                    m_entityHandler->AddComponentsAspect( GetEntity( op.entity ), op.aspect );
+                    break;
+
+                case WORKLOAD_REMOVE:
+                    m_entityHandler->RemoveComponentsAspect( GetEntity( op.entity ), op.aspect );
+                    break;
+
+                case WORKLOAD_COPY:
+                    Map( op.other, m_entityHandler->CopyEntity( GetEntity( op.entity ) ) );
+                    break;
+
+                case WORKLOAD_DESTROY:
+                    m_entityHandler->DestroyEntity( GetEntity( op.entity ) );
+                    m_ids[op.entity] = INVALID_ENTITY;
+                    break;
+
+                case WORKLOAD_ENABLE:
+                case WORKLOAD_DISABLE:
+                    m_entityHandler->SetEnabled( GetEntity( op.entity ), op.type == WORKLOAD_ENABLE );
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        /*!
+            Returns the handlers id of a recorded entity.
+        */
+        Entity GetEntity( Entity recorded )
+        {
+            assert( recorded < m_ids.size() && m_ids[recorded] != INVALID_ENTITY );
+            return m_ids[recorded];
+        }
+
+        /*!
+            Returns the number of operations applied so far, including frame markers.
+        */
+        size_t GetOpCount()
+        {
+            return m_opCount;
+        }
+
+    private:
+        void Map( Entity recorded, Entity id )
+        {
+            if( recorded >= m_ids.size() )
+                m_ids.resize( recorded + 1, INVALID_ENTITY );
+
+            m_ids[recorded] = id;
+        }
+
+        EntityHandlerT *m_entityHandler;
+        WorkloadReader *m_reader;
+        std::vector<Entity> m_ids;
+        std::vector<Entity> m_bulk;
+        size_t m_opCount;
+    };
+}
+
+#endif
@@ -0,0 +1,290 @@
+#include "WorkloadTrace.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#define WORKLOAD_HEADER_SIZE ( 3 * sizeof( uint32_t ) )
+
+namespace Core
+{
+    WorkloadRecorder::WorkloadRecorder( size_t componentCount )
+    {
+        m_componentCount = componentCount;
+        m_frames = 0;
+
+        WriteHeader();
+    }
+
+    void WorkloadRecorder::RecordCreate( Entity id, Aspect asp )
+    {
+        WriteOp( WORKLOAD_CREATE );
+        WriteVarint( id );
+        WriteVarint( asp );
+    }
+
+    void WorkloadRecorder::RecordCreateBulk( const Entity *ids, size_t count, Aspect asp )
+    {
+        WriteOp( WORKLOAD_CREATE_BULK );
+        WriteVarint( asp );
+        WriteVarint( count );
+
+        for( size_t i = 0; i < count; i++ )
+            WriteVarint( ids[i] );
+    }
+
+    void WorkloadRecorder::RecordAdd( Entity id, Aspect asp )
+    {
+        WriteOp( WORKLOAD_ADD );
+        WriteVarint( id );
+        WriteVarint( asp );
+    }
+
+    void WorkloadRecorder::RecordRemove( Entity id, Aspect asp )
+    {
+        WriteOp( WORKLOAD_REMOVE );
+        WriteVarint( id );
+        WriteVarint( asp );
+    }
+
+    void WorkloadRecorder::RecordCopy( Entity source, Entity copy )
+    {
+        WriteOp( WORKLOAD_COPY );
+        WriteVarint( source );
+        WriteVarint( copy );
+    }
+
+    void WorkloadRecorder::RecordDestroy( Entity id )
+    {
+        WriteOp( WORKLOAD_DESTROY );
+        WriteVarint( id );
+    }
+
+    void WorkloadRecorder::RecordEnable( Entity id, bool enabled )
+    {
+        WriteOp( enabled ? WORKLOAD_ENABLE : WORKLOAD_DISABLE );
+        WriteVarint( id );
+    }
+
+    void WorkloadRecorder::MarkFrame( float delta )
+    {
+        WriteOp( WORKLOAD_FRAME );
+
+        unsigned char bytes[sizeof( float )];
+        std::memcpy( bytes, &delta, sizeof( float ) );
+        m_trace.insert( m_trace.end(), bytes, bytes + sizeof( float ) );
+
+        m_frames++;
+    }
+
+    const std::vector<unsigned char>& WorkloadRecorder::GetTrace()
+    {
+        return m_trace;
+    }
+
+    size_t WorkloadRecorder::GetFrameCount()
+    {
+        return m_frames;
+    }
+
+    void WorkloadRecorder::Clear()
+    {
+        m_trace.clear();
+        m_frames = 0;
+
+        WriteHeader();
+    }
+
+    bool WorkloadRecorder::Save( const std::string& path )
+    {
+        FILE *file = fopen( path.c_str(), "wb" );
+
+        if( file == nullptr )
+            return false;
+
+        bool ok = fwrite( &m_trace[0], m_trace.size(), 1, file ) == 1;
+        return fclose( file ) == 0 && ok;
+    }
+
+    void WorkloadRecorder::WriteOp( WorkloadOpType type )
+    {
+        m_trace.push_back( (unsigned char)type );
+    }
+
+    void WorkloadRecorder::WriteVarint( uint64_t value )
+    {
+        while( value >= 0x80 )
+        {
+            m_trace.push_back( (unsigned char)( value | 0x80 ) );
+            value >>= 7;
+        }
+
+        m_trace.push_back( (unsigned char)value );
+    }
+
+    void WorkloadRecorder::WriteHeader()
+    {
+        uint32_t header[3] = { WORKLOAD_TRACE_MAGIC, WORKLOAD_TRACE_VERSION, (uint32_t)m_componentCount };
+
+        const unsigned char *bytes = (const unsigned char*)header;
+        m_trace.insert( m_trace.end(), bytes, bytes + sizeof( header ) );
+    }
+
+    WorkloadReader::WorkloadReader( std::vector<unsigned char> trace )
+    {
+        m_trace = std::move( trace );
+        m_position = WORKLOAD_HEADER_SIZE;
+        m_componentCount = 0;
+        m_valid = false;
+
+        if( m_trace.size() >= WORKLOAD_HEADER_SIZE )
+        {
+            uint32_t header[3];
+            std::memcpy( header, &m_trace[0], sizeof( header ) );
+
+            m_valid = header[0] == WORKLOAD_TRACE_MAGIC && header[1] == WORKLOAD_TRACE_VERSION;
+            m_componentCount = header[2];
+        }
+    }
+
+    WorkloadReader WorkloadReader::Load( const std::string& path )
+    {
+        std::vector<unsigned char> trace;
+
+        FILE *file = fopen( path.c_str(), "rb" );
+
+        if( file != nullptr )
+        {
+            bool ok = false;
+
+            if( fseek( file, 0, SEEK_END ) == 0 )
+            {
+                long size = ftell( file );
+
+                if( size > 0 && fseek( file, 0, SEEK_SET ) == 0 )
+                {
+                    trace.resize( size );
+                    ok = fread( &trace[0], size, 1, file ) == 1;
+                }
+            }
+
+            fclose( file );
+
+            if( ok == false )
+                trace.clear();
+        }
+
+        return WorkloadReader( std::move( trace ) );
+    }
+
+    bool WorkloadReader::IsCompatible( size_t componentCount )
+    {
+        return m_valid && m_componentCount == componentCount;
+    }
+
+    bool WorkloadReader::IsValid()
+    {
+        return m_valid;
+    }
+
+    bool WorkloadReader::Next( WorkloadOp& op )
+    {
+        if( m_valid == false || m_position >= m_trace.size() )
+            return false;
+
+        op.type = (WorkloadOpType)m_trace[m_position++];
+        op.entity = INVALID_ENTITY;
+        op.other = INVALID_ENTITY;
+        op.aspect = 0ULL;
+        op.count = 0;
+        op.delta = 0.0f;
+
+        uint64_t a = 0, b = 0;
+
+        switch( op.type )
+        {
+        case WORKLOAD_FRAME:
+            if( m_position + sizeof( float ) > m_trace.size() )
+                return false;
+
+            std::memcpy( &op.delta, &m_trace[m_position], sizeof( float ) );
+            m_position += sizeof( float );
+            return true;
+
+        case WORKLOAD_CREATE:
+        case WORKLOAD_ADD:
+        case WORKLOAD_REMOVE:
+            if( ReadVarint( a ) == false || ReadVarint( b ) == false )
+                return false;
+
+            op.entity = (Entity)a;
+            op.aspect = b;
+            return true;
+
+        case WORKLOAD_CREATE_BULK:
+            if( ReadVarint( a ) == false || ReadVarint( b ) == false )
+                return false;
+
+            op.aspect = a;
+            op.count = (size_t)b;
+
+            m_bulkIds.resize( op.count );
+            for( size_t i = 0; i < op.count; i++ )
+            {
+                uint64_t id;
+                if( ReadVarint( id ) == false )
+                    return false;
+
+                m_bulkIds[i] = (Entity)id;
+            }
+            return true;
+
+        case WORKLOAD_COPY:
+            if( ReadVarint( a ) == false || ReadVarint( b ) == false )
+                return false;
+
+            op.entity = (Entity)a;
+            op.other = (Entity)b;
+            return true;
+
+        case WORKLOAD_DESTROY:
+        case WORKLOAD_ENABLE:
+        case WORKLOAD_DISABLE:
+            if( ReadVarint( a ) == false )
+                return false;
+
+            op.entity = (Entity)a;
+            return true;
+        }
+
+        //Unknown operation, the trace is corrupt
+        m_valid = false;
+        return false;
+    }
+
+    const std::vector<Entity>& WorkloadReader::GetBulkIds()
+    {
+        return m_bulkIds;
+    }
+
+    void WorkloadReader::Rewind()
+    {
+        m_position = WORKLOAD_HEADER_SIZE;
+    }
+
+    bool WorkloadReader::ReadVarint( uint64_t& value )
+    {
+        value = 0;
+
+        for( int shift = 0; shift < 64 && m_position < m_trace.size(); shift += 7 )
+        {
+            unsigned char byte = m_trace[m_position++];
+            value |= (uint64_t)( byte & 0x7F ) << shift;
+
+            if( ( byte & 0x80 ) == 0 )
+                return true;
+        }
+
+        return false;
+    }
+}
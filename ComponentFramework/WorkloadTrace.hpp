@@ -0,0 +1,154 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_WORKLOADTRACE_H
+#define SRC_CORE_COMPONENTFRAMEWORK_WORKLOADTRACE_H
+
+#include "SystemTypes.hpp"
+
+#include <vector>
+#include <string>
+
+#define WORKLOAD_TRACE_MAGIC 0x4b52574c
+#define WORKLOAD_TRACE_VERSION 1
+
+namespace Core
+{
+    /*!
+        Layout of a workload trace:
+            uint32_t magic, uint32_t version, uint32_t componentCount
+            followed by operations, each an opcode byte and its arguments as LEB128 varints:
+                FRAME           float delta (raw 4 bytes)
+                CREATE          entity, aspect
+                CREATE_BULK     aspect, count, entity[count]
+                ADD             entity, aspect of the added components
+                REMOVE          entity, aspect of the removed components
+                COPY            source entity, new entity
+                DESTROY         entity
+                ENABLE          entity
+                DISABLE         entity
+
+        Entity ids are the ids of the recording handler, a replayer maps them to its own.
+        Component values are not recorded, only which components entities have.
+    */
+    enum WorkloadOpType
+    {
+        WORKLOAD_FRAME,
+        WORKLOAD_CREATE,
+        WORKLOAD_CREATE_BULK,
+        WORKLOAD_ADD,
+        WORKLOAD_REMOVE,
+        WORKLOAD_COPY,
+        WORKLOAD_DESTROY,
+        WORKLOAD_ENABLE,
+        WORKLOAD_DISABLE
+    };
+
+    /*!
+        A decoded operation, see WorkloadReader::Next.
+        For CREATE_BULK the ids are found in WorkloadReader::GetBulkIds.
+    */
+    struct WorkloadOp
+    {
+        WorkloadOpType type;
+        Entity entity;
+        Entity other;
+        Aspect aspect;
+        size_t count;
+        float delta;
+    };
+
+    /*!
+        WorkloadRecorder, builds a compact binary trace of the structural changes made to an EntityHandler.
+        Attach it with EntityHandler::SetRecorder and call MarkFrame at every frame boundary.
+    */
+    class WorkloadRecorder
+    {
+    public:
+        WorkloadRecorder( size_t componentCount );
+
+        void RecordCreate( Entity id, Aspect asp );
+        void RecordCreateBulk( const Entity *ids, size_t count, Aspect asp );
+        void RecordAdd( Entity id, Aspect asp );
+        void RecordRemove( Entity id, Aspect asp );
+        void RecordCopy( Entity source, Entity copy );
+        void RecordDestroy( Entity id );
+        void RecordEnable( Entity id, bool enabled );
+
+        /*!
+            Ends the current frame, delta is handed back to the replayer.
+        */
+        void MarkFrame( float delta );
+
+        const std::vector<unsigned char>& GetTrace();
+
+        /*!
+            Returns the number of frames marked so far.
+        */
+        size_t GetFrameCount();
+
+        /*!
+            Drops everything recorded, keeping the header.
+        */
+        void Clear();
+
+        /*!
+            Writes the trace to path, returns false on failure.
+        */
+        bool Save( const std::string& path );
+
+    private:
+        void WriteOp( WorkloadOpType type );
+        void WriteVarint( uint64_t value );
+        void WriteHeader();
+
+        std::vector<unsigned char> m_trace;
+        size_t m_componentCount;
+        size_t m_frames;
+    };
+
+    /*!
+        WorkloadReader, decodes a trace written by WorkloadRecorder one operation at a time.
+    */
+    class WorkloadReader
+    {
+    public:
+        WorkloadReader( std::vector<unsigned char> trace );
+
+        /*!
+            Reads a trace from disk, IsValid is false if the file couldn't be read.
+        */
+        static WorkloadReader Load( const std::string& path );
+
+        /*!
+            Returns true if the header is well formed and the trace was recorded 
+            from a handler with componentCount components.
+        */
+        bool IsCompatible( size_t componentCount );
+
+        bool IsValid();
+
+        /*!
+            Decodes the next operation, returns false at the end of the trace or if it is truncated.
+        */
+        bool Next( WorkloadOp& op );
+
+        /*!
+            Returns the recorded ids of the last CREATE_BULK operation.
+        */
+        const std::vector<Entity>& GetBulkIds();
+
+        /*!
+            Moves back to the first operation.
+        */
+        void Rewind();
+
+    private:
+        bool ReadVarint( uint64_t& value );
+
+        std::vector<unsigned char> m_trace;
+        std::vector<Entity> m_bulkIds;
+        size_t m_position;
+        size_t m_componentCount;
+        bool m_valid;
+    };
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef SRC_CORE_COMPONENTFRAMEWORK_WORLDTEMPLATE_H
+#define SRC_CORE_COMPONENTFRAMEWORK_WORLDTEMPLATE_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cassert>
+
+#include "SystemTypes.hpp"
+
+namespace Core
+{
+    /*!
+        World, one independent simulation made of a SystemHandler and the EntityHandler 
+        bound to it. Several worlds can live in the same process, for example one per map region,
+        and be stepped on different threads with WorldStepperTemplate.
+
+        Systems are created by their SystemHandler without knowing which world they belong to,
+        they should look up their EntityHandler through GetCurrent() rather than through a global.
+        GetCurrent() is set for the calling thread during Step and by MakeCurrent.
+    */
+    template<typename EntityHandlerT>
+    class WorldTemplate
+    {
+    public:
+        typedef typename EntityHandlerT::SystemHandler SystemHandlerT;
+
+        WorldTemplate() : m_entityHandler( &m_systemHandler )
+        {
+        }
+
+        /*!
+            Updates all systems of this world, with this world current on the calling thread.
+        */
+        void Step( float delta )
+        {
+            WorldTemplate *previous = s_current;
+            s_current = this;
+
+            m_systemHandler.Update( delta );
+
+            s_current = previous;
+        }
+
+        /*!
+            Moves entities to another world, see EntityHandlerTemplate::MigrateEntities.
+            This world is current while its systems see the entities leave and dest 
+            while its systems see them arrive, the previous current world is restored after.
+        */
+        void MigrateEntities( const Entity *ids, size_t count, WorldTemplate& dest, Entity *out )
+        {
+            WorldTemplate *previous = s_current;
+            s_current = this;
+
+            m_entityHandler.MigrateEntities( ids, count, dest.m_entityHandler, out, [&dest](){ s_current = &dest; } );
+
+            s_current = previous;
+        }
+
+        /*!
+            Makes this world current on the calling thread, 
+            for setup code creating entities outside Step.
+        */
+        void MakeCurrent()
+        {
+            s_current = this;
+        }
+
+        /*!
+            Returns the world current on the calling thread, or nullptr.
+        */
+        static WorldTemplate* GetCurrent()
+        {
+            return s_current;
+        }
+
+        EntityHandlerT& GetEntityHandler() { return m_entityHandler; }
+        SystemHandlerT& GetSystemHandler() { return m_systemHandler; }
+
+    private:
+        WorldTemplate( const WorldTemplate& );
+        WorldTemplate& operator=( const WorldTemplate& );
+
+        SystemHandlerT m_systemHandler;
+        EntityHandlerT m_entityHandler;
+
+        static thread_local WorldTemplate *s_current;
+    };
+
+    template<typename EntityHandlerT>
+    thread_local WorldTemplate<EntityHandlerT>* WorldTemplate<EntityHandlerT>::s_current = nullptr;
+
+    /*!
+        Steps a fixed set of worlds in parallel, the first world on the calling thread
+        and every other world on its own persistent worker thread.
+        Entities can be migrated between the worlds between calls to Step.
+    */
+    template<typename WorldT>
+    class WorldStepperTemplate
+    {
+    public:
+        WorldStepperTemplate( const std::vector<WorldT*>& worlds )
+        {
+            m_worlds = worlds;
+            m_generation = 0;
+            m_pending = 0;
+            m_quit = false;
+            m_delta = 0.0f;
+
+            for( size_t i = 1; i < m_worlds.size(); i++ )
+            {
+                m_threads.push_back( std::thread( &WorldStepperTemplate::WorkerLoop, this, i ) );
+            }
+        }
+
+        ~WorldStepperTemplate()
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                m_quit = true;
+            }
+            m_start.notify_all();
+
+            for( size_t i = 0; i < m_threads.size(); i++ )
+                m_threads[i].join();
+        }
+
+        /*!
+            Steps all worlds with the same delta, returns once every world is done.
+        */
+        void Step( float delta )
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                m_delta = delta;
+                m_pending = m_threads.size();
+                m_generation++;
+            }
+            m_start.notify_all();
+
+            if( m_worlds.size() > 0 )
+                m_worlds[0]->Step( delta );
+
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_done.wait( lock, [this]{ return m_pending == 0; } );
+        }
+
+    private:
+        WorldStepperTemplate( const WorldStepperTemplate& );
+        WorldStepperTemplate& operator=( const WorldStepperTemplate& );
+
+        void WorkerLoop( size_t index )
+        {
+            unsigned int seen = 0;
+
+            for( ;; )
+            {
+                float delta;
+                {
+                    std::unique_lock<std::mutex> lock( m_mutex );
+                    m_start.wait( lock, [&]{ return m_quit || m_generation != seen; } );
+
+                    if( m_quit )
+                        return;
+
+                    seen = m_generation;
+                    delta = m_delta;
+                }
+
+                m_worlds[index]->Step( delta );
+
+                {
+                    std::lock_guard<std::mutex> lock( m_mutex );
+                    m_pending--;
+                }
+                m_done.notify_one();
+            }
+        }
+
+        std::vector<WorldT*> m_worlds;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_start;
+        std::condition_variable m_done;
+        unsigned int m_generation;
+        size_t m_pending;
+        bool m_quit;
+        float m_delta;
+    };
+}
+
+#endif
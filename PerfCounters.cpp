@@ -0,0 +1,174 @@
+#include "PerfCounters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdint>
+#endif
+
+namespace Core
+{
+    PerfCounters::PerfCounters()
+    {
+        m_leader = -1;
+        m_opened = 0;
+
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+        {
+            m_fds[i] = -1;
+            m_slots[i] = -1;
+            m_start[i] = 0;
+            m_end[i] = 0;
+        }
+
+        m_startEnabled = m_startRunning = 0;
+        m_endEnabled = m_endRunning = 0;
+    }
+
+    PerfCounters::~PerfCounters()
+    {
+        Close();
+    }
+
+    bool PerfCounters::Open()
+    {
+        if( IsOpen() )
+            return true;
+
+#ifdef __linux__
+        const unsigned long long configs[COUNTER_COUNT] = 
+        {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+        {
+            perf_event_attr attr;
+            std::memset( &attr, 0, sizeof( attr ) );
+
+            attr.size = sizeof( attr );
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.disabled = m_leader == -1 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            //All counters in one group so they are scheduled and read together
+            int fd = (int)syscall( __NR_perf_event_open, &attr, 0, -1, m_leader, 0 );
+
+            if( fd < 0 )
+                continue;
+
+            if( m_leader == -1 )
+                m_leader = fd;
+
+            m_fds[i] = fd;
+            m_slots[i] = m_opened++;
+        }
+
+        if( m_leader == -1 )
+            return false;
+
+        ioctl( m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+        ioctl( m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void PerfCounters::Close()
+    {
+#ifdef __linux__
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+        {
+            if( m_fds[i] >= 0 )
+                close( m_fds[i] );
+
+            m_fds[i] = -1;
+            m_slots[i] = -1;
+        }
+#endif
+        m_leader = -1;
+        m_opened = 0;
+    }
+
+    bool PerfCounters::IsOpen()
+    {
+        return m_leader != -1;
+    }
+
+    void PerfCounters::Start()
+    {
+        if( IsOpen() )
+            Read( m_start, m_startEnabled, m_startRunning );
+    }
+
+    void PerfCounters::Stop()
+    {
+        if( IsOpen() )
+            Read( m_end, m_endEnabled, m_endRunning );
+    }
+
+    PerfCounterValues PerfCounters::GetDelta()
+    {
+        long long delta[COUNTER_COUNT];
+
+        long long enabled = m_endEnabled - m_startEnabled;
+        long long running = m_endRunning - m_startRunning;
+
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+        {
+            if( m_slots[i] < 0 )
+            {
+                delta[i] = -1;
+                continue;
+            }
+
+            delta[i] = m_end[i] - m_start[i];
+
+            if( running > 0 && running < enabled )
+                delta[i] = (long long)( (double)delta[i] * enabled / running );
+        }
+
+        PerfCounterValues values = { delta[CYCLES], delta[INSTRUCTIONS], delta[CACHE_MISSES], delta[BRANCH_MISSES] };
+        return values;
+    }
+
+    bool PerfCounters::Read( long long* values, long long& enabled, long long& running )
+    {
+#ifdef __linux__
+        //Layout of a PERF_FORMAT_GROUP read: nr, time_enabled, time_running, value[nr]
+        uint64_t buffer[3 + COUNTER_COUNT];
+
+        ssize_t size = read( m_leader, buffer, sizeof( buffer ) );
+
+        if( size < (ssize_t)( ( 3 + m_opened ) * sizeof( uint64_t ) ) )
+            return false;
+
+        enabled = (long long)buffer[1];
+        running = (long long)buffer[2];
+
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+        {
+            if( m_slots[i] >= 0 )
+                values[i] = (long long)buffer[3 + m_slots[i]];
+        }
+
+        return true;
+#else
+        (void)values;
+        (void)enabled;
+        (void)running;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+namespace Core
+{
+    /*!
+        Hardware counter values for a measured section, -1 when the counter is unavailable.
+    */
+    struct PerfCounterValues
+    {
+        long long cycles;
+        long long instructions;
+        long long cacheMisses;
+        long long branchMisses;
+    };
+
+    /*!
+        PerfCounters, reads cycles, instructions, last level cache misses and branch misses
+        for the calling thread through perf_event_open.
+
+        Only implemented on Linux, elsewhere or when the kernel refuses the counters
+        (no PMU, perf_event_paranoid, containers) Open returns false and all values are -1.
+        Counters the hardware lacks are reported as -1 while the others keep working.
+    */
+    class PerfCounters
+    {
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        PerfCounters( const PerfCounters& ) = delete;
+        PerfCounters& operator=( const PerfCounters& ) = delete;
+
+        /*!
+            Opens the counters for the calling thread.
+            \return Returns true if at least one counter is available
+        */
+        bool Open();
+
+        /*!
+            Closes the counters
+        */
+        void Close();
+
+        bool IsOpen();
+
+        /*!
+            Starts measuring
+        */
+        void Start();
+
+        /*!
+            Stops measuring
+        */
+        void Stop();
+
+        /*!
+            Gets the counts between calling Start and Stop, scaled up if the
+            kernel had to multiplex the counters with other users.
+        */
+        PerfCounterValues GetDelta();
+
+    private:
+        enum
+        {
+            CYCLES,
+            INSTRUCTIONS,
+            CACHE_MISSES,
+            BRANCH_MISSES,
+            COUNTER_COUNT
+        };
+
+        bool Read( long long* values, long long& enabled, long long& running );
+
+        int m_fds[COUNTER_COUNT];
+        int m_leader;
+        int m_slots[COUNTER_COUNT];
+        int m_opened;
+
+        long long m_start[COUNTER_COUNT], m_end[COUNTER_COUNT];
+        long long m_startEnabled, m_startRunning;
+        long long m_endEnabled, m_endRunning;
+    };
+}
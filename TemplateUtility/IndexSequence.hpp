@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Core
+{
+    /*!
+        Compile-time list of indices, used to expand a parameter pack
+        together with the position of each element.
+        MakeIndexSequence<3>::type is IndexSequence<0,1,2>.
+    */
+    template <std::size_t... I>
+    struct IndexSequence {};
+
+    template <std::size_t N, std::size_t... I>
+    struct MakeIndexSequence : MakeIndexSequence<N-1, N-1, I...> {};
+
+    template <std::size_t... I>
+    struct MakeIndexSequence<0, I...> {
+        typedef IndexSequence<I...> type;
+    };
+}
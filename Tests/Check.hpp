@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the behaviour tests in this directory. Each test is a standalone program
+// built together with the framework sources from the repository root, for example
+//     g++ -std=c++11 -I. ComponentFramework/*.cpp *.cpp Tests/DoubleBufferTest.cpp -pthread
+// and returns non zero if any check failed.
+static int s_checkFailures = 0;
+
+#define CHECK( cond ) \
+    do { if( !( cond ) ) { std::printf( "%s:%d: CHECK( %s ) failed\n", __FILE__, __LINE__, #cond ); s_checkFailures++; } } while( 0 )
+
+#define CHECK_RESULT() \
+    ( std::printf( s_checkFailures == 0 ? "passed\n" : "%d checks failed\n", s_checkFailures ), s_checkFailures == 0 ? 0 : 1 )
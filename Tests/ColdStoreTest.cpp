@@ -0,0 +1,107 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Health
+{
+    int hp;
+    static const char* GetName() { return "Health"; }
+};
+
+class PositionSystem : public Core::BaseSystem
+{
+public:
+    PositionSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+typedef Core::SystemHandlerTemplate<PositionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Health> EntityHandler;
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+    PositionSystem *system = systemHandler.GetSystem<PositionSystem>();
+
+    std::vector<Core::Entity> ids;
+    for( int i = 0; i < 100; i++ )
+        ids.push_back( entityHandler.CreateEntity( Position{ (float)i, 0.5f }, Health{ i % 7 == 0 ? 100 : i } ) );
+
+    entityHandler.Freeze( &ids[0], ids.size() );
+
+    CHECK( entityHandler.GetFrozenCount() == ids.size() );
+    CHECK( entityHandler.IsFrozen( ids[3] ) );
+    CHECK( system->GetEntityCount() == 0 );
+    CHECK( entityHandler.GetComponentCount() == 0 );
+
+    //Reading a frozen entity finds nothing and leaves it frozen
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[3] ) == nullptr );
+    CHECK( entityHandler.GetComponentReadPointer<Health>( ids[3] ) == nullptr );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( entityHandler.GetHandle( ids[3] ) ) == nullptr );
+
+    Position position = { -1.0f, -1.0f };
+    void *buffers[] = { &position };
+    CHECK( entityHandler.ReadComponents( EntityHandler::GenerateAspect<Position>(), &ids[3], 1, buffers ) == 0 );
+
+    int componentId = 0;
+    entityHandler.GetComponentIds( 0, &ids[3], 1, &componentId );
+    CHECK( componentId == Core::COLD_COMPONENT );
+    CHECK( entityHandler.IsFrozen( ids[3] ) );
+    CHECK( entityHandler.GetFrozenCount() == ids.size() );
+
+    //Copies and prefabs decode the frozen data without thawing
+    Core::Entity copy = entityHandler.CopyEntity( ids[14] );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( copy )->x == 14.0f );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( copy )->hp == 100 );
+    CHECK( entityHandler.IsFrozen( ids[14] ) );
+
+    //Thaw brings the data back but keeps the entities disabled
+    entityHandler.Thaw( &ids[0], 50 );
+    CHECK( entityHandler.GetFrozenCount() == 50 );
+    CHECK( entityHandler.IsEnabled( ids[3] ) == false );
+    CHECK( system->GetEntityCount() == 1 );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[3] )->x == 3.0f );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( ids[7] )->hp == 100 );
+
+    //Enabling thaws the rest
+    entityHandler.SetEnabled( &ids[0], ids.size(), true );
+    CHECK( entityHandler.GetFrozenCount() == 0 );
+    CHECK( system->GetEntityCount() == ids.size() + 1 );
+
+    bool restored = true;
+    for( size_t i = 0; i < ids.size(); i++ )
+    {
+        restored = restored && entityHandler.GetComponentTmpPointer<Position>( ids[i] )->x == (float)i;
+        restored = restored && entityHandler.GetComponentTmpPointer<Position>( ids[i] )->y == 0.5f;
+        restored = restored && entityHandler.GetComponentTmpPointer<Health>( ids[i] )->hp == ( i % 7 == 0 ? 100 : (int)i );
+    }
+    CHECK( restored );
+
+    //Destroying a frozen entity drops its data
+    Core::EntityHandle handle = entityHandler.GetHandle( ids[0] );
+
+    entityHandler.Freeze( &ids[0], 10 );
+    CHECK( entityHandler.GetFrozenCount() == 10 );
+    CHECK( entityHandler.GetFrozenMemoryUse() > 0 );
+    CHECK( entityHandler.IsValid( handle ) );
+
+    for( size_t i = 0; i < 10; i++ )
+        entityHandler.DestroyEntity( ids[i] );
+
+    CHECK( entityHandler.GetFrozenCount() == 0 );
+    CHECK( entityHandler.IsValid( handle ) == false );
+    CHECK( entityHandler.GetHandle( ids[0] ).id == INVALID_ENTITY );
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,143 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+#include <cstring>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Health
+{
+    int hp;
+    bool alive;
+    static const char* GetName() { return "Health"; }
+};
+
+COMPONENT_FIELDS( Position, COMPONENT_FIELD( Position, x ), COMPONENT_FIELD( Position, y ) )
+COMPONENT_FIELDS( Health, COMPONENT_FIELD( Health, hp ), COMPONENT_FIELD( Health, alive ) )
+
+class PositionSystem : public Core::BaseSystem
+{
+public:
+    PositionSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+typedef Core::SystemHandlerTemplate<PositionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Health> EntityHandler;
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+    PositionSystem *system = systemHandler.GetSystem<PositionSystem>();
+
+    //Types and fields are found by name
+    const Core::ComponentRegistry& registry = entityHandler.GetRegistry();
+    CHECK( registry.GetCount() == 2 );
+
+    int positionType = registry.Find( "Position" );
+    int healthType = registry.Find( "Health" );
+    CHECK( positionType == (int)EntityHandler::GetComponentType<Position>() );
+    CHECK( healthType == (int)EntityHandler::GetComponentType<Health>() );
+    CHECK( registry.Find( "Velocity" ) == -1 );
+    CHECK( registry.Get( healthType ).size == sizeof( Health ) );
+
+    const Core::ComponentField *x = registry.FindField( positionType, "x" );
+    const Core::ComponentField *y = registry.FindField( positionType, "y" );
+    const Core::ComponentField *hp = registry.FindField( healthType, "hp" );
+    CHECK( x != nullptr && x->offset == offsetof( Position, x ) && x->type == Core::FIELD_FLOAT );
+    CHECK( hp != nullptr && hp->size == sizeof( int ) && hp->type == Core::FIELD_INT );
+    CHECK( registry.FindField( healthType, "alive" )->type == Core::FIELD_BOOL );
+    CHECK( registry.FindField( healthType, "x" ) == nullptr );
+
+    const char *names[] = { "Position", "Health" };
+    const char *unknown[] = { "Position", "Velocity" };
+    Core::Aspect both = registry.GetAspect( names, 2 );
+    CHECK( ( both == EntityHandler::GenerateAspect<Position,Health>() ) );
+    CHECK( registry.GetAspect( unknown, 2 ) == 0ULL );
+
+    //Bulk creation, Health gets its default value
+    const size_t COUNT = 64;
+    std::vector<Position> positions( COUNT );
+    for( size_t i = 0; i < COUNT; i++ )
+        positions[i] = Position{ (float)i, 0.0f };
+
+    const void *createBuffers[] = { &positions[0], nullptr };
+    std::vector<Core::Entity> ids( COUNT );
+    entityHandler.CreateEntities( both, COUNT, createBuffers, &ids[0] );
+
+    CHECK( system->GetEntityCount() == COUNT );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[10] )->x == 10.0f );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( ids[10] )->hp == 0 );
+
+    //Fields written in bulk read back the same, the other fields are untouched
+    std::vector<float> written( COUNT );
+    for( size_t i = 0; i < COUNT; i++ )
+        written[i] = (float)i * -2.0f;
+
+    CHECK( entityHandler.WriteField( positionType, *y, &ids[0], COUNT, &written[0] ) == COUNT );
+
+    std::vector<float> read( COUNT, 1.0f );
+    CHECK( entityHandler.ReadField( positionType, *y, &ids[0], COUNT, &read[0] ) == COUNT );
+    CHECK( read == written );
+
+    CHECK( entityHandler.ReadField( positionType, *x, &ids[0], COUNT, &read[0] ) == COUNT );
+    bool untouched = true;
+    for( size_t i = 0; i < COUNT; i++ )
+        untouched = untouched && read[i] == (float)i;
+    CHECK( untouched );
+
+    std::vector<int> hps( COUNT );
+    for( size_t i = 0; i < COUNT; i++ )
+        hps[i] = (int)i * 3;
+
+    CHECK( entityHandler.WriteField( healthType, *hp, &ids[0], COUNT, &hps[0] ) == COUNT );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( ids[7] )->hp == 21 );
+
+    //Entities lacking the component are skipped on write and read back the default
+    entityHandler.RemoveComponents<Health>( ids[5] );
+
+    std::vector<int> hpsRead( COUNT, -1 );
+    CHECK( entityHandler.WriteField( healthType, *hp, &ids[0], COUNT, &hps[0] ) == COUNT - 1 );
+    CHECK( entityHandler.ReadField( healthType, *hp, &ids[0], COUNT, &hpsRead[0] ) == COUNT - 1 );
+    CHECK( hpsRead[5] == 0 && hpsRead[6] == 18 );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( ids[5] ) == nullptr );
+
+    //Whole components round trip the same way
+    std::vector<Position> positionsRead( COUNT );
+    std::vector<Health> healthRead( COUNT );
+    void *readBuffers[] = { &positionsRead[0], &healthRead[0] };
+    CHECK( entityHandler.ReadComponents( both, &ids[0], COUNT, readBuffers ) == COUNT - 1 );
+    CHECK( positionsRead[3].x == 3.0f && positionsRead[3].y == -6.0f && healthRead[3].hp == 9 );
+
+    for( size_t i = 0; i < COUNT; i++ )
+        positionsRead[i].x += 100.0f;
+
+    const void *writeBuffers[] = { &positionsRead[0], &healthRead[0] };
+    CHECK( entityHandler.WriteComponents( both, &ids[0], COUNT, writeBuffers ) == COUNT - 1 );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[5] )->x == 105.0f );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[63] )->x == 163.0f );
+
+    //Views index the storage by component id
+    Core::ComponentView view = entityHandler.GetComponentView( positionType, false );
+    std::vector<int> componentIds( COUNT );
+    entityHandler.GetComponentIds( positionType, &ids[0], COUNT, &componentIds[0] );
+
+    bool viewed = true;
+    for( size_t i = 0; i < COUNT; i++ )
+    {
+        const Position *position = (const Position*)( (const unsigned char*)view.data + componentIds[i] * view.typesize );
+        viewed = viewed && (size_t)componentIds[i] < view.count && position->x == (float)i + 100.0f;
+    }
+    CHECK( viewed );
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,119 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Velocity
+{
+    float x, y;
+    static const char* GetName() { return "Velocity"; }
+};
+
+static std::vector<int> s_updates;
+
+class MoveSystem : public Core::BaseSystem
+{
+public:
+    MoveSystem() : BaseSystem( 3ULL, 0ULL ) {}
+    virtual void Update( float ) { s_updates.push_back( 0 ); }
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+//Sees every change itself, affected or not
+class ListenerSystem : public Core::BaseSystem
+{
+public:
+    ListenerSystem() : BaseSystem( 2ULL, 0ULL ) { calls = 0; }
+    virtual void Update( float ) { s_updates.push_back( 1 ); }
+
+    virtual void ChangedEntity( Core::Entity id, Core::Aspect old_asp, Core::Aspect new_asp )
+    {
+        BaseSystem::ChangedEntity( id, old_asp, new_asp );
+        calls++;
+    }
+
+    size_t GetEntityCount() { return m_entities.size(); }
+
+    int calls;
+};
+
+class RenderSystem : public Core::BaseSystem
+{
+public:
+    RenderSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) { s_updates.push_back( 2 ); }
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+typedef Core::SystemHandlerTemplate<MoveSystem,ListenerSystem,RenderSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Velocity> EntityHandler;
+
+static_assert( Core::OverridesChangedEntity<ListenerSystem>::value, "ListenerSystem is called per entity" );
+static_assert( !Core::OverridesChangedEntity<MoveSystem>::value, "MoveSystem is called in batches" );
+static_assert( EntityHandler::GenerateAspect<Position,Velocity>() == 3ULL, "Aspects are compile-time constants" );
+static_assert( SystemHandler::SYSTEM_COUNT == 3, "" );
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+
+    MoveSystem *move = systemHandler.GetSystem<MoveSystem>();
+    ListenerSystem *listener = systemHandler.GetSystem<ListenerSystem>();
+    RenderSystem *render = systemHandler.GetSystem<RenderSystem>();
+
+    //Systems live in the handler, in the order they were listed
+    CHECK( systemHandler.GetSystem( 0 ) == move );
+    CHECK( systemHandler.GetSystem( 1 ) == listener );
+    CHECK( systemHandler.GetSystem( 2 ) == render );
+
+    systemHandler.Update( 0.016f );
+    systemHandler.Update( 0.016f );
+    CHECK( s_updates.size() == 6 );
+    for( size_t i = 0; i < s_updates.size(); i++ )
+        CHECK( s_updates[i] == (int)( i % 3 ) );
+
+    //Each system only takes the entities matching its aspect
+    Core::Entity still = entityHandler.CreateEntity( Position{ 0.0f, 0.0f } );
+    Core::Entity moving = entityHandler.CreateEntity( Position{ 0.0f, 0.0f }, Velocity{ 1.0f, 0.0f } );
+
+    CHECK( move->GetEntityCount() == 1 );
+    CHECK( listener->GetEntityCount() == 1 );
+    CHECK( render->GetEntityCount() == 2 );
+    CHECK( listener->calls == 2 );
+
+    //Batched changes reach the overriding system once per entity
+    Core::Entity batch[] = { 10, 11, 12, 13 };
+    systemHandler.CallChangedEntities( batch, 4, 0ULL, 3ULL );
+
+    CHECK( move->GetEntityCount() == 5 );
+    CHECK( listener->GetEntityCount() == 5 );
+    CHECK( render->GetEntityCount() == 6 );
+    CHECK( listener->calls == 6 );
+
+    systemHandler.CallChangedEntities( batch, 4, 3ULL, 1ULL );
+
+    CHECK( move->GetEntityCount() == 1 );
+    CHECK( listener->GetEntityCount() == 1 );
+    CHECK( render->GetEntityCount() == 6 );
+    CHECK( listener->calls == 10 );
+
+    entityHandler.RemoveComponents<Velocity>( moving );
+    CHECK( move->GetEntityCount() == 0 );
+    CHECK( listener->GetEntityCount() == 0 );
+    CHECK( render->GetEntityCount() == 6 );
+
+    entityHandler.DestroyEntity( still );
+    CHECK( render->GetEntityCount() == 5 );
+    CHECK( listener->calls == 12 );
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,68 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+DOUBLE_BUFFERED_COMPONENT( Position )
+
+class PositionSystem : public Core::BaseSystem
+{
+public:
+    PositionSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+};
+
+typedef Core::SystemHandlerTemplate<PositionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position> EntityHandler;
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+
+    Core::Entity written = entityHandler.CreateEntity( Position{ 1.0f, 1.0f } );
+    Core::Entity untouched = entityHandler.CreateEntity( Position{ 2.0f, 2.0f } );
+
+    //New components are readable right away
+    CHECK( entityHandler.GetComponentReadPointer<Position>( written )->x == 1.0f );
+
+    //A write shows up in the read buffer after the next swap only
+    entityHandler.GetComponentTmpPointer<Position>( written )->x = 5.0f;
+    CHECK( entityHandler.GetComponentReadPointer<Position>( written )->x == 1.0f );
+
+    entityHandler.SwapComponentBuffers();
+    CHECK( entityHandler.GetComponentReadPointer<Position>( written )->x == 5.0f );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( written )->x == 5.0f );
+
+    //Slots left alone for several frames keep their latest value in both buffers
+    for( int frame = 0; frame < 3; frame++ )
+    {
+        entityHandler.SwapComponentBuffers();
+
+        CHECK( entityHandler.GetComponentReadPointer<Position>( written )->x == 5.0f );
+        CHECK( entityHandler.GetComponentReadPointer<Position>( untouched )->x == 2.0f );
+
+        const Core::ComponentView view = entityHandler.GetComponentView( 0, false );
+        int componentId = 0;
+        entityHandler.GetComponentIds( 0, &written, 1, &componentId );
+        CHECK( ((const Position*)view.data)[componentId].x == 5.0f );
+    }
+
+    //Read-modify-write across frames sees the previous write
+    for( int frame = 0; frame < 4; frame++ )
+    {
+        entityHandler.GetComponentTmpPointer<Position>( untouched )->y += 1.0f;
+        entityHandler.SwapComponentBuffers();
+        entityHandler.SwapComponentBuffers();
+    }
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( untouched )->y == 6.0f );
+    CHECK( entityHandler.GetComponentReadPointer<Position>( untouched )->y == 6.0f );
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,154 @@
+#include <ComponentFramework/EntityBag.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+#include <algorithm>
+
+struct KeyTable
+{
+    std::vector<uint32_t> keys;
+    int reads;
+};
+
+static uint32_t ReadKey( Core::Entity id, void *context )
+{
+    KeyTable *table = static_cast<KeyTable*>( context );
+    table->reads++;
+    return table->keys[id];
+}
+
+static bool IsSorted( Core::EntityBag& bag, KeyTable& table )
+{
+    const std::vector<Core::Entity>& sorted = bag.GetSortedEntities();
+
+    for( size_t i = 1; i < sorted.size(); i++ )
+    {
+        if( table.keys[sorted[i-1]] > table.keys[sorted[i]] )
+            return false;
+    }
+
+    return sorted.size() == bag.m_entities.size();
+}
+
+static void CheckSorting()
+{
+    //Two bags share the key function, each reads its own table through the context
+    KeyTable materials = { std::vector<uint32_t>( 32 ), 0 };
+    KeyTable cells = { std::vector<uint32_t>( 32 ), 0 };
+
+    for( size_t i = 0; i < 32; i++ )
+    {
+        materials.keys[i] = (uint32_t)( i % 3 );
+        cells.keys[i] = (uint32_t)( 1000 - i );
+    }
+
+    Core::EntityBag byMaterial( 1ULL, 0ULL );
+    Core::EntityBag byCell( 1ULL, 0ULL );
+    byMaterial.SetSortKey( ReadKey, &materials );
+    byCell.SetSortKey( ReadKey, &cells );
+
+    for( Core::Entity id = 0; id < 12; id++ )
+    {
+        byMaterial.ChangedEntity( id, 0ULL, 1ULL );
+        byCell.ChangedEntity( id, 0ULL, 1ULL );
+    }
+
+    byMaterial.Sort();
+    byCell.Sort();
+
+    CHECK( IsSorted( byMaterial, materials ) );
+    CHECK( IsSorted( byCell, cells ) && byCell.GetSortedEntities()[0] == 11 );
+
+    const std::vector<Core::EntityGroup>& groups = byMaterial.GetGroups();
+    CHECK( groups.size() == 3 );
+    for( size_t i = 0; i < groups.size(); i++ )
+        CHECK( groups[i].key == i && groups[i].count == 4 && groups[i].begin == i * 4 );
+
+    //Every Sort reads every key once
+    materials.reads = 0;
+    byMaterial.Sort();
+    CHECK( materials.reads == 12 );
+
+    //Changed keys, leaving and joining entities are merged in
+    materials.keys[4] = 0;
+    byMaterial.ChangedEntity( 0, 1ULL, 0ULL );
+    byMaterial.ChangedEntity( 20, 0ULL, 1ULL );
+    byMaterial.ChangedEntity( 21, 0ULL, 1ULL );
+    byMaterial.ChangedEntity( 21, 1ULL, 0ULL );
+
+    materials.reads = 0;
+    byMaterial.Sort();
+    CHECK( materials.reads == 12 );
+    CHECK( IsSorted( byMaterial, materials ) );
+    CHECK( byMaterial.GetGroups()[0].count == 4 && byMaterial.GetGroups()[1].count == 3 );
+    CHECK( byMaterial.GetGroups()[2].count == 5 );
+
+    //Leaving and joining again between two Sorts keeps one copy
+    byMaterial.ChangedEntity( 5, 1ULL, 0ULL );
+    byMaterial.ChangedEntity( 5, 0ULL, 1ULL );
+    byMaterial.Sort();
+    CHECK( IsSorted( byMaterial, materials ) );
+    CHECK( std::count( byMaterial.GetSortedEntities().begin(), byMaterial.GetSortedEntities().end(), 5 ) == 1 );
+}
+
+static bool Listed( const std::vector<Core::Entity>& list, Core::Entity id )
+{
+    return std::find( list.begin(), list.end(), id ) != list.end();
+}
+
+int main()
+{
+    Core::EntityBag bag( 1ULL, 0ULL, true );
+
+    for( Core::Entity id = 0; id < 8; id++ )
+        bag.ChangedEntity( id, 0ULL, 1ULL );
+
+    CHECK( bag.GetAdded().size() == 8 && bag.GetRemoved().empty() );
+
+    //Joining and leaving in the same period cancel out, the other additions are kept
+    bag.ChangedEntity( 3, 1ULL, 0ULL );
+    CHECK( bag.GetAdded().size() == 7 && Listed( bag.GetAdded(), 3 ) == false );
+    CHECK( bag.GetRemoved().empty() );
+    CHECK( bag.Contains( 3 ) == false );
+
+    bag.ClearChanges();
+    CHECK( bag.GetAdded().empty() && bag.GetRemoved().empty() );
+
+    //Leaving and joining again is seen as both
+    bag.ChangedEntity( 5, 1ULL, 0ULL );
+    bag.ChangedEntity( 5, 0ULL, 1ULL );
+    CHECK( bag.GetRemoved().size() == 1 && bag.GetRemoved()[0] == 5 );
+    CHECK( bag.GetAdded().size() == 1 && bag.GetAdded()[0] == 5 );
+    CHECK( bag.Contains( 5 ) );
+
+    //And leaving once more cancels only the join
+    bag.ChangedEntity( 5, 1ULL, 0ULL );
+    CHECK( bag.GetRemoved().size() == 1 && bag.GetAdded().empty() );
+    CHECK( bag.Contains( 5 ) == false );
+
+    bag.ClearChanges();
+
+    //Changes that keep the entity in the bag are not recorded
+    bag.ChangedEntity( 6, 1ULL, 3ULL );
+    CHECK( bag.GetAdded().empty() && bag.GetRemoved().empty() );
+
+    //Batched joins are recorded and cancel out like single ones
+    Core::Entity batch[] = { 10, 11, 12 };
+    bag.ChangedEntities( batch, 3, 0ULL, 1ULL );
+    bag.ChangedEntity( 11, 1ULL, 0ULL );
+    CHECK( bag.GetAdded().size() == 2 && Listed( bag.GetAdded(), 10 ) && Listed( bag.GetAdded(), 12 ) );
+    CHECK( bag.GetRemoved().empty() );
+
+    //Bags not tracking changes record nothing
+    Core::EntityBag untracked( 1ULL, 0ULL );
+    untracked.ChangedEntity( 1, 0ULL, 1ULL );
+    untracked.ChangedEntity( 2, 0ULL, 1ULL );
+    untracked.ChangedEntity( 1, 1ULL, 0ULL );
+    CHECK( untracked.GetAdded().empty() && untracked.GetRemoved().empty() );
+    CHECK( untracked.m_entities.size() == 1 && untracked.Contains( 2 ) );
+
+    CheckSorting();
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,155 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Health
+{
+    int hp;
+    static const char* GetName() { return "Health"; }
+};
+
+class PositionSystem : public Core::BaseSystem
+{
+public:
+    PositionSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+typedef Core::SystemHandlerTemplate<PositionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Health> EntityHandler;
+
+static bool WaitWritten( Core::EntityStreamer& streamer, std::string& path )
+{
+    bool ok = false;
+    streamer.Flush();
+    CHECK( streamer.PopWritten( path, ok ) );
+    return ok;
+}
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+    PositionSystem *system = systemHandler.GetSystem<PositionSystem>();
+    Core::EntityStreamer streamer;
+
+    const size_t COUNT = 1000;
+    std::vector<Core::Entity> ids;
+
+    for( size_t i = 0; i < COUNT; i++ )
+    {
+        if( i % 2 == 0 )
+            ids.push_back( entityHandler.CreateEntity( Position{ (float)i, -(float)i }, Health{ (int)i } ) );
+        else
+            ids.push_back( entityHandler.CreateEntity( Position{ (float)i, -(float)i } ) );
+    }
+
+    //A failed write leaves the entities in place
+    std::vector<unsigned char> block;
+    entityHandler.EvictEntities( &ids[0], ids.size(), block );
+    CHECK( system->GetEntityCount() == 0 );
+
+    std::string path;
+    streamer.Write( "/nonexistent-directory/entities.block", block );
+    bool written = WaitWritten( streamer, path );
+    CHECK( written == false );
+
+    entityHandler.CompleteEviction( &ids[0], ids.size(), written );
+    CHECK( entityHandler.GetEntityCount() == (int)COUNT );
+    CHECK( system->GetEntityCount() == COUNT );
+    CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[10] )->x == 10.0f );
+
+    //A successful write destroys them, reading the block back recreates them
+    const char *file = "EntityStreamTest.block";
+    entityHandler.EvictEntities( &ids[0], ids.size(), block );
+    streamer.Write( file, block );
+    written = WaitWritten( streamer, path );
+    CHECK( written && path == file );
+
+    entityHandler.CompleteEviction( &ids[0], ids.size(), written );
+    CHECK( entityHandler.GetEntityCount() == 0 );
+
+    streamer.Read( file );
+    streamer.Flush();
+
+    bool ok = false;
+    CHECK( streamer.PopLoaded( path, block, ok ) && ok );
+    std::remove( file );
+
+    Core::EntityBlockReader reader( block );
+    CHECK( entityHandler.IsCompatible( reader ) );
+
+    std::vector<Core::Entity> loaded;
+    while( reader.IsDone() == false )
+        entityHandler.LoadEntities( reader, 128, loaded );
+
+    CHECK( loaded.size() == COUNT );
+    CHECK( system->GetEntityCount() == COUNT );
+
+    //Entities come back grouped by aspect, check them by their values
+    size_t withHealth = 0;
+    for( size_t i = 0; i < loaded.size(); i++ )
+    {
+        Position *position = entityHandler.GetComponentTmpPointer<Position>( loaded[i] );
+        Health *health = entityHandler.GetComponentTmpPointer<Health>( loaded[i] );
+
+        CHECK( position != nullptr && position->y == -position->x );
+
+        if( health != nullptr )
+        {
+            CHECK( health->hp == (int)position->x && health->hp % 2 == 0 );
+            withHealth++;
+        }
+    }
+    CHECK( withHealth == COUNT / 2 );
+
+    //Blocks written with other component sizes are refused
+    block[sizeof( Core::EntityBlockHeader )] += 4;
+    Core::EntityBlockReader mismatched( block );
+    CHECK( entityHandler.IsCompatible( mismatched ) == false );
+    CHECK( entityHandler.LoadEntities( mismatched, COUNT, loaded ) == 0 );
+    CHECK( loaded.size() == COUNT );
+
+    //Corrupt counts are refused rather than read out of bounds
+    block[sizeof( Core::EntityBlockHeader )] -= 4;
+    CHECK( Core::EntityBlockReader( block ).GetEntityCount() == COUNT );
+
+    Core::EntityBlockHeader header;
+    memcpy( &header, &block[0], sizeof( header ) );
+
+    std::vector<unsigned char> corrupt = block;
+    Core::EntityBlockHeader tooManyComponents = header;
+    tooManyComponents.componentCount = 65;
+    memcpy( &corrupt[0], &tooManyComponents, sizeof( header ) );
+    CHECK( Core::EntityBlockReader( corrupt ).GetEntityCount() == 0 );
+
+    corrupt = block;
+    Core::EntityBlockHeader tooManyEntities = header;
+    tooManyEntities.entityCount = 0xffffffff;
+    memcpy( &corrupt[0], &tooManyEntities, sizeof( header ) );
+    CHECK( Core::EntityBlockReader( corrupt ).GetEntityCount() == 0 );
+
+    corrupt = block;
+    Core::Aspect unknown = 1ULL << 63;
+    memcpy( &corrupt[sizeof( header ) + header.componentCount * sizeof( uint32_t )], &unknown, sizeof( unknown ) );
+    CHECK( Core::EntityBlockReader( corrupt ).GetEntityCount() == 0 );
+
+    corrupt = block;
+    uint32_t hugeSize = 0xffffffff;
+    memcpy( &corrupt[sizeof( header )], &hugeSize, sizeof( hugeSize ) );
+    CHECK( Core::EntityBlockReader( corrupt ).GetEntityCount() == 0 );
+
+    return CHECK_RESULT();
+}
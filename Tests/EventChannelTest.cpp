@@ -0,0 +1,79 @@
+#include <ComponentFramework/EventChannel.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+#include <thread>
+
+struct Hit
+{
+    int producer;
+    int sequence;
+};
+
+static const int PRODUCER_COUNT = 4;
+static const int EVENTS_PER_PRODUCER = 10000;
+
+int main()
+{
+    //Producers publish while the consumer drains, nothing is lost and
+    //every producers events arrive in the order it published them
+    Core::EventChannel<Hit> channel( 256 );
+
+    std::vector<std::thread> producers;
+    for( int p = 0; p < PRODUCER_COUNT; p++ )
+    {
+        producers.push_back( std::thread( [&channel, p]()
+        {
+            for( int i = 0; i < EVENTS_PER_PRODUCER; i++ )
+            {
+                while( channel.Publish( Hit{ p, i } ) == false )
+                    std::this_thread::yield();
+            }
+        } ) );
+    }
+
+    std::vector<int> next( PRODUCER_COUNT, 0 );
+    bool ordered = true;
+    int received = 0;
+
+    Hit hits[64];
+    while( received < PRODUCER_COUNT * EVENTS_PER_PRODUCER )
+    {
+        size_t count = channel.Drain( hits, 64 );
+
+        for( size_t i = 0; i < count; i++ )
+        {
+            ordered = ordered && hits[i].sequence == next[hits[i].producer];
+            next[hits[i].producer] = hits[i].sequence + 1;
+        }
+
+        received += (int)count;
+    }
+
+    for( size_t i = 0; i < producers.size(); i++ )
+        producers[i].join();
+
+    CHECK( ordered );
+    CHECK( channel.Drain( hits, 64 ) == 0 );
+    for( int p = 0; p < PRODUCER_COUNT; p++ )
+        CHECK( next[p] == EVENTS_PER_PRODUCER );
+
+    //A full channel drops and counts what doesn't fit
+    Core::EventChannel<Hit> small( 5 );
+    CHECK( small.GetCapacity() == 8 );
+
+    for( int i = 0; i < 10; i++ )
+        small.Publish( Hit{ 0, i } );
+
+    CHECK( small.GetDropped() == 2 );
+    CHECK( small.Consume( []( const Hit& ) {} ) == 8 );
+
+    //Clear drops everything and the channel can be reused
+    small.Publish( Hit{ 0, 0 } );
+    small.Clear();
+    CHECK( small.Drain( hits, 64 ) == 0 );
+    CHECK( small.Publish( Hit{ 1, 1 } ) && small.Drain( hits, 64 ) == 1 && hits[0].producer == 1 );
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,70 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+struct Transform
+{
+    float local, world;
+    static const char* GetName() { return "Transform"; }
+};
+
+class TransformSystem : public Core::BaseSystem
+{
+public:
+    TransformSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+};
+
+typedef Core::SystemHandlerTemplate<TransformSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Transform> EntityHandler;
+
+static void Combine( const Transform& parent, Transform& child )
+{
+    child.world = parent.world + child.local;
+}
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+
+    Core::Entity root = entityHandler.CreateEntity( Transform{ 1.0f, 1.0f } );
+    Core::Entity child = entityHandler.CreateEntity( Transform{ 2.0f, 0.0f } );
+    Core::Entity grandChild = entityHandler.CreateEntity( Transform{ 4.0f, 0.0f } );
+
+    CHECK( entityHandler.SetParent( grandChild, child ) );
+    CHECK( entityHandler.SetParent( child, root ) );
+    CHECK( entityHandler.GetParent( grandChild ) == child );
+    CHECK( entityHandler.GetParent( root ) == INVALID_ENTITY );
+
+    //Links that would make an entity its own ancestor are refused
+    CHECK( entityHandler.SetParent( root, grandChild ) == false );
+    CHECK( entityHandler.SetParent( root, root ) == false );
+    CHECK( entityHandler.GetParent( root ) == INVALID_ENTITY );
+
+    //Parents are propagated before their children, whatever order the links were made in
+    entityHandler.PropagateHierarchy<Transform>( Combine );
+    CHECK( entityHandler.GetComponentTmpPointer<Transform>( child )->world == 3.0f );
+    CHECK( entityHandler.GetComponentTmpPointer<Transform>( grandChild )->world == 7.0f );
+
+    //Destroying an entity makes its children roots
+    entityHandler.DestroyEntity( child );
+    CHECK( entityHandler.GetParent( grandChild ) == INVALID_ENTITY );
+
+    entityHandler.GetComponentTmpPointer<Transform>( grandChild )->world = 0.0f;
+    entityHandler.PropagateHierarchy<Transform>( Combine );
+    CHECK( entityHandler.GetComponentTmpPointer<Transform>( grandChild )->world == 0.0f );
+
+    //Released ids can't be linked
+    CHECK( entityHandler.SetParent( child, root ) == false );
+    CHECK( entityHandler.SetParent( grandChild, child ) == false );
+    CHECK( entityHandler.GetParent( grandChild ) == INVALID_ENTITY );
+
+    Core::Entity reused = entityHandler.CreateEntity( Transform{ 8.0f, 0.0f } );
+    CHECK( reused == child );
+    CHECK( entityHandler.GetParent( reused ) == INVALID_ENTITY );
+    CHECK( entityHandler.SetParent( reused, root ) );
+
+    return CHECK_RESULT();
+}
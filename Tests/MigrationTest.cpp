@@ -0,0 +1,96 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+#include <ComponentFramework/SpatialGridSystem.hpp>
+#include <ComponentFramework/WorldTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Health
+{
+    int hp;
+    static const char* GetName() { return "Health"; }
+};
+
+//Reads positions from whichever world is current, like systems shared by several worlds should
+struct GridPolicy
+{
+    static Core::Aspect GetAspect() { return 1ULL; }
+    void GetPosition( Core::Entity id, float& x, float& y );
+};
+
+typedef Core::SpatialGridSystem<GridPolicy> GridSystem;
+typedef Core::SystemHandlerTemplate<GridSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Health> EntityHandler;
+typedef Core::WorldTemplate<EntityHandler> World;
+
+void GridPolicy::GetPosition( Core::Entity id, float& x, float& y )
+{
+    const Position *position = World::GetCurrent()->GetEntityHandler().GetComponentTmpPointer<Position>( id );
+    x = position->x;
+    y = position->y;
+}
+
+int main()
+{
+    World west, east;
+
+    west.MakeCurrent();
+    std::vector<Core::Entity> ids;
+    for( int i = 0; i < 8; i++ )
+    {
+        if( i % 2 == 0 )
+            ids.push_back( west.GetEntityHandler().CreateEntity( Position{ i * 4.0f, 0.0f } ) );
+        else
+            ids.push_back( west.GetEntityHandler().CreateEntity( Position{ i * 4.0f, 0.0f }, Health{ i } ) );
+    }
+
+    //Entities already in east take the low ids, so the moved entities get ids west never had
+    east.MakeCurrent();
+    Core::Entity resident = east.GetEntityHandler().CreateEntity( Position{ 100.0f, 100.0f } );
+    for( int i = 0; i < 16; i++ )
+        east.GetEntityHandler().CreateEntity( Health{ i } );
+
+    //East's grid reads the arriving positions from east
+    Core::Entity moved[4];
+    west.MigrateEntities( &ids[2], 4, east, moved );
+
+    CHECK( World::GetCurrent() == &east );
+
+    GridSystem *westGrid = west.GetSystemHandler().GetSystem<GridSystem>();
+    GridSystem *eastGrid = east.GetSystemHandler().GetSystem<GridSystem>();
+
+    Core::Entity nearest[2];
+    for( int i = 0; i < 4; i++ )
+    {
+        float x = ( i + 2 ) * 4.0f;
+
+        CHECK( eastGrid->QueryNearest( x, 0.0f, 1, 0.5f, nearest ) == 1 && nearest[0] == moved[i] );
+        CHECK( westGrid->QueryNearest( x, 0.0f, 1, 0.5f, nearest ) == 0 );
+        CHECK( east.GetEntityHandler().GetComponentTmpPointer<Position>( moved[i] )->x == x );
+    }
+
+    CHECK( east.GetEntityHandler().GetComponentTmpPointer<Health>( moved[1] )->hp == 3 );
+    CHECK( east.GetEntityHandler().GetComponentTmpPointer<Health>( moved[0] ) == nullptr );
+    CHECK( eastGrid->QueryNearest( 100.0f, 100.0f, 1, 0.5f, nearest ) == 1 && nearest[0] == resident );
+
+    CHECK( westGrid->QueryNearest( 0.0f, 0.0f, 2, 0.5f, nearest ) == 1 && nearest[0] == ids[0] );
+    CHECK( westGrid->QueryNearest( 28.0f, 0.0f, 2, 0.5f, nearest ) == 1 && nearest[0] == ids[7] );
+
+    //And back, the world current before the call is current again after it
+    Core::Entity back;
+    east.MigrateEntities( &resident, 1, west, &back );
+
+    CHECK( World::GetCurrent() == &east );
+    CHECK( westGrid->QueryNearest( 100.0f, 100.0f, 1, 0.5f, nearest ) == 1 && nearest[0] == back );
+    CHECK( eastGrid->QueryNearest( 100.0f, 100.0f, 1, 0.5f, nearest ) == 0 );
+
+    return CHECK_RESULT();
+}
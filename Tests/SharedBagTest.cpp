@@ -0,0 +1,124 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Velocity
+{
+    float x, y;
+    static const char* GetName() { return "Velocity"; }
+};
+
+struct Frozen
+{
+    int frames;
+    static const char* GetName() { return "Frozen"; }
+};
+
+class MoveSystem : public Core::BaseSystem
+{
+public:
+    MoveSystem()
+    {
+        m_moving = UseSharedBag( 3ULL, 4ULL );
+    }
+
+    virtual void Update( float ) {}
+    const Core::EntityBag& GetMoving() { return GetSharedBag( m_moving ); }
+
+private:
+    int m_moving;
+};
+
+//Same query as MoveSystem, checks the shared bag is already up to date when it is told about a change
+class CollisionSystem : public Core::BaseSystem
+{
+public:
+    CollisionSystem()
+    {
+        m_moving = UseSharedBag( 3ULL, 4ULL );
+        m_all = UseSharedBag( 1ULL, 0ULL );
+        inBagWhenAdded = true;
+        calls = 0;
+    }
+
+    virtual void Update( float ) {}
+
+    virtual void ChangedEntity( Core::Entity id, Core::Aspect old_asp, Core::Aspect new_asp )
+    {
+        BaseSystem::ChangedEntity( id, old_asp, new_asp );
+
+        if( ( new_asp & 7ULL ) == 3ULL )
+            inBagWhenAdded = inBagWhenAdded && GetMoving().m_entities.size() > 0 && GetSharedBag( m_moving ).m_entities.back() == id;
+
+        calls++;
+    }
+
+    const Core::EntityBag& GetMoving() { return GetSharedBag( m_moving ); }
+    const Core::EntityBag& GetAll() { return GetSharedBag( m_all ); }
+
+    bool inBagWhenAdded;
+    int calls;
+
+private:
+    int m_moving;
+    int m_all;
+};
+
+typedef Core::SystemHandlerTemplate<MoveSystem,CollisionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Velocity,Frozen> EntityHandler;
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+
+    MoveSystem *move = systemHandler.GetSystem<MoveSystem>();
+    CollisionSystem *collision = systemHandler.GetSystem<CollisionSystem>();
+
+    //Identical queries are interned into one bag
+    CHECK( systemHandler.GetSharedBagCount() == 2 );
+    CHECK( &move->GetMoving() == &collision->GetMoving() );
+    CHECK( &collision->GetAll() != &collision->GetMoving() );
+
+    Core::Entity still = entityHandler.CreateEntity( Position{ 0.0f, 0.0f } );
+    Core::Entity moving = entityHandler.CreateEntity( Position{ 0.0f, 0.0f }, Velocity{ 1.0f, 0.0f } );
+    Core::Entity frozen = entityHandler.CreateEntity( Position{ 0.0f, 0.0f }, Velocity{ 1.0f, 0.0f }, Frozen{ 10 } );
+
+    //Each entity is listed once per shared bag
+    CHECK( move->GetMoving().m_entities.size() == 1 && move->GetMoving().m_entities[0] == moving );
+    CHECK( collision->GetAll().m_entities.size() == 3 );
+    CHECK( collision->inBagWhenAdded );
+
+    //Batched changes update the shared bags too
+    Core::Entity batch[] = { 20, 21, 22 };
+    systemHandler.CallChangedEntities( batch, 3, 0ULL, 3ULL );
+    CHECK( move->GetMoving().m_entities.size() == 4 );
+    CHECK( collision->GetAll().m_entities.size() == 6 );
+
+    systemHandler.CallChangedEntities( batch, 3, 3ULL, 0ULL );
+    CHECK( move->GetMoving().m_entities.size() == 1 );
+
+    //Entities move between bags as their aspect changes
+    entityHandler.RemoveComponents<Frozen>( frozen );
+    CHECK( move->GetMoving().m_entities.size() == 2 && move->GetMoving().m_entities[1] == frozen );
+
+    entityHandler.AddComponents( moving, Frozen{ 5 } );
+    CHECK( move->GetMoving().m_entities.size() == 1 && move->GetMoving().m_entities[0] == frozen );
+
+    entityHandler.DestroyEntity( still );
+    entityHandler.DestroyEntity( frozen );
+    CHECK( move->GetMoving().m_entities.empty() );
+    CHECK( collision->GetAll().m_entities.size() == 1 && collision->GetAll().m_entities[0] == moving );
+
+    //Systems without their own lists still see every change they override ChangedEntity for
+    CHECK( collision->calls == 3 + 3 + 3 + 4 );
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,64 @@
+#include <ComponentFramework/SharedWorldRegion.hpp>
+
+#include "Check.hpp"
+
+#include <cstdint>
+
+int main()
+{
+    Core::SharedComponentDesc components[] = { { "Position", 8, true, 1000 }, { "Health", 4, false, 500 } };
+    const char *systems[] = { "MoveSystem" };
+
+    Core::SharedWorldRegion writer;
+    if( writer.Create( "/kravall-shared-world-test", components, 2, 2000, 2 * sizeof( int ), systems, 1 ) == false )
+    {
+        //No shared memory in this environment
+        return 0;
+    }
+
+    Core::SharedWorldRegion reader;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) );
+    CHECK( reader.GetHeader()->entityRowSize == 2 * sizeof( int ) );
+    CHECK( reader.GetComponent( 0 )->previousOffset != reader.GetComponent( 0 )->currentOffset );
+    CHECK( reader.GetComponent( 1 )->previousOffset == reader.GetComponent( 1 )->currentOffset );
+    reader.Close();
+
+    //Every table and buffer the header describes has to lie within the object
+    Core::SharedWorldHeader *header = writer.GetHeader();
+    Core::SharedComponentInfo *position = writer.GetComponent( 0 );
+    Core::SharedComponentInfo *health = writer.GetComponent( 1 );
+
+    uint32_t componentCount = header->componentCount;
+    header->componentCount = 0xffffffff;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) == false && reader.IsOpen() == false );
+    header->componentCount = componentCount;
+
+    uint64_t entityCapacity = header->entityCapacity;
+    header->entityCapacity = 0xffffffffffffffffULL / 4;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) == false );
+    header->entityCapacity = entityCapacity;
+
+    uint64_t entityOffset = header->entityOffset;
+    header->entityOffset = header->totalSize + 1;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) == false );
+    header->entityOffset = entityOffset;
+
+    uint64_t previousOffset = position->previousOffset;
+    position->previousOffset = header->totalSize - 8;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) == false );
+    position->previousOffset = previousOffset;
+
+    uint64_t capacity = health->capacity;
+    health->capacity = 0x4000000000000001ULL;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) == false );
+    health->capacity = capacity;
+
+    uint32_t version = header->version;
+    header->version = Core::SHARED_WORLD_VERSION + 1;
+    CHECK( reader.Open( "/kravall-shared-world-test" ) == false );
+    header->version = version;
+
+    CHECK( reader.Open( "/kravall-shared-world-test" ) );
+
+    return CHECK_RESULT();
+}
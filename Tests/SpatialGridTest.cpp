@@ -0,0 +1,96 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+#include <ComponentFramework/SpatialGridSystem.hpp>
+#include <ComponentFramework/WorldTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+#include <algorithm>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct GridPolicy
+{
+    static Core::Aspect GetAspect() { return 1ULL; }
+    void GetPosition( Core::Entity id, float& x, float& y );
+};
+
+typedef Core::SpatialGridSystem<GridPolicy> GridSystem;
+typedef Core::SystemHandlerTemplate<GridSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position> EntityHandler;
+typedef Core::WorldTemplate<EntityHandler> World;
+
+void GridPolicy::GetPosition( Core::Entity id, float& x, float& y )
+{
+    const Position *position = World::GetCurrent()->GetEntityHandler().GetComponentTmpPointer<Position>( id );
+    x = position->x;
+    y = position->y;
+}
+
+int main()
+{
+    World world;
+    world.MakeCurrent();
+
+    EntityHandler& entityHandler = world.GetEntityHandler();
+    GridSystem *grid = world.GetSystemHandler().GetSystem<GridSystem>();
+    grid->SetGrid( -64.0f, -64.0f, 4.0f, 32, 32 );
+
+    //A 10 by 10 lattice two units apart, ids in creation order
+    std::vector<Core::Entity> ids;
+    for( int y = 0; y < 10; y++ )
+    {
+        for( int x = 0; x < 10; x++ )
+            ids.push_back( entityHandler.CreateEntity( Position{ x * 2.0f, y * 2.0f } ) );
+    }
+
+    std::vector<Core::Entity> found;
+    grid->QueryRadius( 0.0f, 0.0f, 2.5f, found );
+    std::sort( found.begin(), found.end() );
+    CHECK( found.size() == 3 && found[0] == ids[0] && found[1] == ids[1] && found[2] == ids[10] );
+
+    //Nearest is sorted by distance and bounded by the radius
+    Core::Entity nearest[4];
+    CHECK( grid->QueryNearest( 10.1f, 10.2f, 4, 0.0f, nearest ) == 4 );
+    CHECK( nearest[0] == ids[55] );
+    CHECK( nearest[1] == ids[65] && nearest[2] == ids[56] && nearest[3] == ids[54] );
+    CHECK( grid->QueryNearest( 10.1f, 10.2f, 4, 1.0f, nearest ) == 1 );
+
+    //Far outside the grid the border cells are searched
+    CHECK( grid->QueryNearest( 500.0f, 500.0f, 1, 0.0f, nearest ) == 1 && nearest[0] == ids[99] );
+
+    //Batched queries give the same results as single ones
+    Core::SpatialQuery queries[] = { { 18.0f, 18.0f, 0.5f }, { 0.0f, 0.0f, 2.5f }, { 100.0f, 100.0f, 1.0f } };
+    std::vector<Core::Entity> results;
+    std::vector<Core::SpatialQueryRange> ranges;
+    grid->QueryRadius( queries, 3, results, ranges );
+    CHECK( ranges[0].count == 1 && results[ranges[0].begin] == ids[99] );
+    CHECK( ranges[1].count == 3 );
+    CHECK( ranges[2].count == 0 );
+
+    Core::Entity batched[3 * 2];
+    grid->QueryNearest( queries, 3, 2, batched );
+    CHECK( batched[0] == ids[99] && batched[1] == INVALID_ENTITY );
+    CHECK( batched[2] == ids[0] );
+    CHECK( batched[4] == INVALID_ENTITY && batched[5] == INVALID_ENTITY );
+
+    //Update moves entities that changed cell
+    entityHandler.GetComponentTmpPointer<Position>( ids[0] )->x = 40.0f;
+    world.Step( 0.016f );
+
+    found.clear();
+    grid->QueryRadius( 0.0f, 0.0f, 0.5f, found );
+    CHECK( found.empty() );
+    CHECK( grid->QueryNearest( 40.0f, 0.0f, 1, 0.5f, nearest ) == 1 && nearest[0] == ids[0] );
+
+    //Destroyed entities leave the grid
+    entityHandler.DestroyEntity( ids[0] );
+    CHECK( grid->QueryNearest( 40.0f, 0.0f, 1, 0.5f, nearest ) == 0 );
+
+    return CHECK_RESULT();
+}
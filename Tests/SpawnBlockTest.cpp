@@ -0,0 +1,105 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+#include <thread>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Health
+{
+    int hp;
+    static const char* GetName() { return "Health"; }
+};
+
+class PositionSystem : public Core::BaseSystem
+{
+public:
+    PositionSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+typedef Core::SystemHandlerTemplate<PositionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Health> EntityHandler;
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+    PositionSystem *system = systemHandler.GetSystem<PositionSystem>();
+
+    //A fixed reservation refuses entities beyond it
+    EntityHandler::SpawnBlock fixed;
+    entityHandler.BeginSpawnBlock( fixed, 3 );
+
+    std::vector<Core::Entity> ids;
+    for( int i = 0; i < 3; i++ )
+        ids.push_back( fixed.Create( Position{ (float)i, 0.0f } ) );
+
+    CHECK( fixed.Create( Position{ 3.0f, 0.0f } ) == INVALID_ENTITY );
+    CHECK( fixed.Create( Position{ 4.0f, 0.0f }, Health{ 4 } ) == INVALID_ENTITY );
+    CHECK( fixed.GetCount() == 3 );
+
+    entityHandler.CommitSpawnBlock( fixed );
+    CHECK( entityHandler.GetEntityCount() == 3 );
+    CHECK( system->GetEntityCount() == 3 );
+
+    for( int i = 0; i < 3; i++ )
+        CHECK( entityHandler.GetComponentTmpPointer<Position>( ids[i] )->x == (float)i );
+
+    //A committed block can be begun again
+    entityHandler.BeginSpawnBlock( fixed, 1 );
+    Core::Entity single = fixed.Create( Position{ 5.0f, 0.0f }, Health{ 5 } );
+    CHECK( single != INVALID_ENTITY );
+    CHECK( fixed.Create( Position{ 6.0f, 0.0f } ) == INVALID_ENTITY );
+    entityHandler.CommitSpawnBlock( fixed );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( single )->hp == 5 );
+
+    //Chunked blocks refill as they go, from several threads at once
+    const int THREAD_COUNT = 4;
+    const int PER_THREAD = 100;
+
+    std::vector<EntityHandler::SpawnBlock> blocks( THREAD_COUNT );
+    std::vector<std::vector<Core::Entity>> spawned( THREAD_COUNT );
+
+    for( int t = 0; t < THREAD_COUNT; t++ )
+        entityHandler.BeginSpawnBlock( blocks[t], 0, 16 );
+
+    std::vector<std::thread> threads;
+    for( int t = 0; t < THREAD_COUNT; t++ )
+    {
+        threads.push_back( std::thread( [&blocks, &spawned, t, PER_THREAD]()
+        {
+            for( int i = 0; i < PER_THREAD; i++ )
+                spawned[t].push_back( blocks[t].Create( Position{ (float)t, (float)i } ) );
+        } ) );
+    }
+
+    for( int t = 0; t < THREAD_COUNT; t++ )
+        threads[t].join();
+
+    for( int t = 0; t < THREAD_COUNT; t++ )
+        entityHandler.CommitSpawnBlock( blocks[t] );
+
+    CHECK( system->GetEntityCount() == 4 + THREAD_COUNT * PER_THREAD );
+
+    bool placed = true;
+    for( int t = 0; t < THREAD_COUNT; t++ )
+    {
+        for( int i = 0; i < PER_THREAD; i++ )
+        {
+            Position *position = entityHandler.GetComponentTmpPointer<Position>( spawned[t][i] );
+            placed = placed && position != nullptr && position->x == (float)t && position->y == (float)i;
+        }
+    }
+    CHECK( placed );
+
+    return CHECK_RESULT();
+}
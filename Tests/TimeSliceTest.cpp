@@ -0,0 +1,138 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+#include <ComponentFramework/TimeSlicedSystem.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+#include <set>
+#include <thread>
+
+struct Brain
+{
+    int thoughts;
+    static const char* GetName() { return "Brain"; }
+};
+
+class ThinkSystem : public Core::TimeSlicedSystem
+{
+public:
+    ThinkSystem() : TimeSlicedSystem( 1ULL, 0ULL, 2 )
+    {
+        passes = 0;
+    }
+
+    int passes;
+    std::vector<int> visits;
+
+protected:
+    virtual void UpdateBatch( const Core::Entity* entities, size_t count, float )
+    {
+        for( size_t i = 0; i < count; i++ )
+        {
+            if( entities[i] >= visits.size() )
+                visits.resize( entities[i] + 1, 0 );
+
+            visits[entities[i]]++;
+        }
+
+        //Make sure every batch spends the smallest budget
+        std::this_thread::sleep_for( std::chrono::microseconds( 10 ) );
+    }
+
+    virtual void EndPass() { passes++; }
+};
+
+typedef Core::SystemHandlerTemplate<ThinkSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Brain> EntityHandler;
+
+static void CheckCursorBag()
+{
+    Core::EntityBag bag( 1ULL, 0ULL );
+
+    for( Core::Entity id = 0; id < 10; id++ )
+        bag.ChangedEntity( id, 0ULL, 1ULL );
+
+    bag.SetCursor( 5 );
+    std::set<Core::Entity> visited( bag.m_entities.begin(), bag.m_entities.begin() + 5 );
+
+    //Leaving before the cursor moves it back, the visited entities stay before it
+    bag.ChangedEntity( 2, 1ULL, 0ULL );
+    visited.erase( 2 );
+
+    CHECK( bag.GetCursor() == 4 );
+    CHECK( std::set<Core::Entity>( bag.m_entities.begin(), bag.m_entities.begin() + 4 ) == visited );
+    CHECK( bag.m_entities.size() == 9 );
+
+    //Leaving after the cursor leaves it alone
+    bag.ChangedEntity( 8, 1ULL, 0ULL );
+
+    CHECK( bag.GetCursor() == 4 );
+    CHECK( std::set<Core::Entity>( bag.m_entities.begin(), bag.m_entities.begin() + 4 ) == visited );
+    CHECK( bag.Contains( 8 ) == false && bag.m_entities.size() == 8 );
+
+    //Joining appends after the cursor
+    bag.ChangedEntity( 20, 0ULL, 1ULL );
+    CHECK( bag.m_entities.back() == 20 && bag.GetCursor() == 4 );
+}
+
+int main()
+{
+    CheckCursorBag();
+
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+    ThinkSystem *system = systemHandler.GetSystem<ThinkSystem>();
+
+    std::vector<Core::Entity> ids;
+    for( int i = 0; i < 10; i++ )
+        ids.push_back( entityHandler.CreateEntity( Brain{ 0 } ) );
+
+    //A budget this small lets one batch of two through per frame
+    systemHandler.SetFrameBudget<ThinkSystem>( std::chrono::microseconds( 1 ) );
+
+    systemHandler.Update( 0.016f );
+    systemHandler.Update( 0.016f );
+    CHECK( system->passes == 0 );
+
+    //Destroy one entity that was visited and one that wasn't yet
+    Core::Entity visitedId = INVALID_ENTITY, pendingId = INVALID_ENTITY;
+    for( size_t i = 0; i < ids.size(); i++ )
+    {
+        bool seen = ids[i] < system->visits.size() && system->visits[ids[i]] > 0;
+
+        if( seen && visitedId == INVALID_ENTITY )
+            visitedId = ids[i];
+        if( seen == false && pendingId == INVALID_ENTITY )
+            pendingId = ids[i];
+    }
+
+    entityHandler.DestroyEntity( visitedId );
+    entityHandler.DestroyEntity( pendingId );
+
+    //Three more batches visit the five entities left after the cursor,
+    //the pass ends at the start of the next frame
+    for( int frame = 0; frame < 3; frame++ )
+        systemHandler.Update( 0.016f );
+    CHECK( system->passes == 0 );
+
+    systemHandler.Update( 0.016f );
+    CHECK( system->passes == 1 );
+
+    //Every remaining entity was visited exactly once
+    system->visits.resize( ids.size(), 0 );
+    for( size_t i = 0; i < ids.size(); i++ )
+    {
+        if( ids[i] == pendingId )
+            CHECK( system->visits[ids[i]] == 0 );
+        else
+            CHECK( system->visits[ids[i]] == 1 );
+    }
+
+    //Without a budget a whole pass runs every frame
+    systemHandler.SetFrameBudget<ThinkSystem>( std::chrono::microseconds( 0 ) );
+    systemHandler.Update( 0.016f );
+    CHECK( system->passes == 2 );
+
+    return CHECK_RESULT();
+}
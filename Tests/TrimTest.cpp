@@ -0,0 +1,138 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+#include <ComponentFramework/EntityHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+
+struct Position
+{
+    float x, y;
+    static const char* GetName() { return "Position"; }
+};
+
+struct Health
+{
+    int hp;
+    static const char* GetName() { return "Health"; }
+};
+
+class PositionSystem : public Core::BaseSystem
+{
+public:
+    PositionSystem() : BaseSystem( 1ULL, 0ULL ) {}
+    virtual void Update( float ) {}
+    size_t GetEntityCount() { return m_entities.size(); }
+};
+
+typedef Core::SystemHandlerTemplate<PositionSystem> SystemHandler;
+typedef Core::EntityHandlerTemplate<SystemHandler,Position,Health> EntityHandler;
+
+static bool Intact( EntityHandler& entityHandler, const std::vector<Core::Entity>& ids, const std::vector<int>& values )
+{
+    bool intact = true;
+
+    for( size_t i = 0; i < ids.size(); i++ )
+    {
+        Position *position = entityHandler.GetComponentTmpPointer<Position>( ids[i] );
+        Health *health = entityHandler.GetComponentTmpPointer<Health>( ids[i] );
+
+        intact = intact && position != nullptr && position->x == (float)values[i] && position->y == -(float)values[i];
+
+        if( values[i] % 2 == 0 )
+            intact = intact && health != nullptr && health->hp == values[i];
+        else
+            intact = intact && health == nullptr;
+    }
+
+    return intact;
+}
+
+int main()
+{
+    SystemHandler systemHandler;
+    EntityHandler entityHandler( &systemHandler );
+    PositionSystem *system = systemHandler.GetSystem<PositionSystem>();
+
+    const int COUNT = 20000;
+
+    std::vector<Core::Entity> all;
+    for( int i = 0; i < COUNT; i++ )
+    {
+        if( i % 2 == 0 )
+            all.push_back( entityHandler.CreateEntity( Position{ (float)i, -(float)i }, Health{ i } ) );
+        else
+            all.push_back( entityHandler.CreateEntity( Position{ (float)i, -(float)i } ) );
+    }
+
+    //Keep the top of the storage and a few scattered below, so more slots move than one step does
+    std::vector<Core::Entity> kept;
+    std::vector<int> values;
+    for( int i = 0; i < COUNT; i++ )
+    {
+        if( i >= 14000 || i % 100 == 0 )
+        {
+            kept.push_back( all[i] );
+            values.push_back( i );
+        }
+        else
+        {
+            entityHandler.DestroyEntity( all[i] );
+        }
+    }
+
+    int allocatedBefore = std::get<4>( entityHandler.GetComponentUsage<Position>() );
+
+    //A budget of zero does one step per call
+    int calls = 1;
+    while( entityHandler.Trim( std::chrono::microseconds( 0 ) ) == false )
+        calls++;
+
+    CHECK( calls > 2 );
+    CHECK( Intact( entityHandler, kept, values ) );
+    CHECK( system->GetEntityCount() == kept.size() );
+
+    //Every entity now points at the compacted slots
+    std::vector<int> componentIds( kept.size() );
+    entityHandler.GetComponentIds( EntityHandler::GetComponentType<Position>(), &kept[0], kept.size(), &componentIds[0] );
+
+    bool compact = true;
+    for( size_t i = 0; i < componentIds.size(); i++ )
+        compact = compact && componentIds[i] >= 0 && componentIds[i] < (int)kept.size();
+    CHECK( compact );
+
+    entityHandler.GetComponentIds( EntityHandler::GetComponentType<Health>(), &kept[0], kept.size(), &componentIds[0] );
+
+    int healthCount = std::get<1>( entityHandler.GetComponentUsage<Health>() );
+    compact = true;
+    for( size_t i = 0; i < componentIds.size(); i++ )
+    {
+        if( values[i] % 2 == 0 )
+            compact = compact && componentIds[i] >= 0 && componentIds[i] < healthCount;
+        else
+            compact = compact && componentIds[i] < 0;
+    }
+    CHECK( compact );
+
+    CHECK( std::get<4>( entityHandler.GetComponentUsage<Position>() ) < allocatedBefore );
+
+    //Trimming compacted storage takes one step per component type
+    calls = 1;
+    while( entityHandler.Trim( std::chrono::microseconds( 0 ) ) == false )
+        calls++;
+
+    CHECK( calls == EntityHandler::COMPONENT_COUNT );
+    CHECK( Intact( entityHandler, kept, values ) );
+
+    //The storage is used as before
+    Core::Entity created = entityHandler.CreateEntity( Position{ 1.0f, -1.0f }, Health{ 1 } );
+    CHECK( entityHandler.GetComponentTmpPointer<Health>( created )->hp == 1 );
+    CHECK( Intact( entityHandler, kept, values ) );
+
+    entityHandler.DestroyEntity( kept.back() );
+    kept.pop_back();
+    values.pop_back();
+    CHECK( Intact( entityHandler, kept, values ) );
+
+    return CHECK_RESULT();
+}
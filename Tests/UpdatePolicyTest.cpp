@@ -0,0 +1,82 @@
+#include <ComponentFramework/SystemHandlerTemplate.hpp>
+
+#include "Check.hpp"
+
+#include <vector>
+
+//Deltas are multiples of 1/8 so the accumulated time is exact
+
+class PhysicsSystem : public Core::BaseSystem
+{
+public:
+    PhysicsSystem() : BaseSystem( 1ULL, 0ULL )
+    {
+        SetUpdatePolicy( Core::UpdatePolicy::FixedStep( 0.25f, 3 ) );
+    }
+
+    virtual void Update( float delta ) { deltas.push_back( delta ); }
+
+    std::vector<float> deltas;
+};
+
+class FirstAiSystem : public Core::BaseSystem
+{
+public:
+    FirstAiSystem() : BaseSystem( 1ULL, 0ULL )
+    {
+        SetUpdatePolicy( Core::UpdatePolicy::EveryNthFrame( 3 ) );
+    }
+
+    virtual void Update( float delta ) { deltas.push_back( delta ); }
+
+    std::vector<float> deltas;
+};
+
+class SecondAiSystem : public FirstAiSystem
+{
+};
+
+typedef Core::SystemHandlerTemplate<PhysicsSystem,FirstAiSystem,SecondAiSystem> SystemHandler;
+
+int main()
+{
+    SystemHandler systemHandler;
+    PhysicsSystem *physics = systemHandler.GetSystem<PhysicsSystem>();
+    FirstAiSystem *first = systemHandler.GetSystem<FirstAiSystem>();
+    SecondAiSystem *second = systemHandler.GetSystem<SecondAiSystem>();
+
+    //Fixed step runs whole steps and carries the rest to the next frame
+    systemHandler.Update( 0.625f );
+    CHECK( physics->deltas.size() == 2 && physics->deltas[0] == 0.25f && physics->deltas[1] == 0.25f );
+
+    //A long frame is clamped to maxSteps and the time beyond is dropped, keeping the fraction
+    systemHandler.Update( 2.0f );
+    CHECK( physics->deltas.size() == 5 );
+
+    systemHandler.Update( 0.125f );
+    CHECK( physics->deltas.size() == 6 );
+
+    systemHandler.Update( 0.125f );
+    CHECK( physics->deltas.size() == 6 );
+
+    //Systems with the same interval and AUTO_PHASE are staggered, frames 0 and 3 for the first,
+    //frames 1 and 4 for the second, each gets the time accumulated since its last update
+    CHECK( first->deltas.size() == 2 && first->deltas[0] == 0.625f && first->deltas[1] == 2.25f );
+    CHECK( second->deltas.size() == 1 && second->deltas[0] == 2.625f );
+
+    systemHandler.Update( 0.5f );
+    CHECK( first->deltas.size() == 2 );
+    CHECK( second->deltas.size() == 2 && second->deltas[1] == 0.75f );
+
+    //Changing the policy through the handler recalculates the phases, frame 5 is phase 2
+    systemHandler.SetUpdatePolicy<SecondAiSystem>( Core::UpdatePolicy::EveryNthFrame( 3, 2 ) );
+
+    systemHandler.Update( 0.125f );
+    CHECK( second->deltas.size() == 3 && second->deltas[2] == 0.125f );
+
+    systemHandler.Update( 0.125f );
+    CHECK( second->deltas.size() == 3 );
+    CHECK( first->deltas.size() == 3 );
+
+    return CHECK_RESULT();
+}